@@ -0,0 +1,192 @@
+#include "batch.h"
+#include "benchmark.h"
+#include "options.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace
+{
+    int64_t toNanoseconds(std::chrono::steady_clock::time_point when)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count();
+    }
+
+    bool readFloat(const std::string& text, float& value)
+    {
+        int used = 0;
+        return std::sscanf(text.c_str(), "%f%n", &value, &used) == 1 && used == (int)text.size();
+    }
+
+    bool readVec3(const std::string& text, glm::vec3& value)
+    {
+        int used = 0;
+        return std::sscanf(text.c_str(), "%f,%f,%f%n", &value.x, &value.y, &value.z, &used) == 3 && used == (int)text.size();
+    }
+
+    bool readField(const std::string& key, const std::string& text, BatchJob& job)
+    {
+        if (key == "eye")
+            return readVec3(text, job.eye);
+        if (key == "target")
+            return readVec3(text, job.target);
+        if (key == "up")
+            return readVec3(text, job.up);
+        if (key == "fov")
+            return readFloat(text, job.fov) && job.fov > 0.0f && job.fov < 180.0f;
+        if (key == "near")
+            return readFloat(text, job.nearPlane) && job.nearPlane > 0.0f;
+        if (key == "far")
+            return readFloat(text, job.farPlane) && job.farPlane > 0.0f;
+        if (key == "spin")
+            return readFloat(text, job.spin);
+        if (key == "time")
+            return readFloat(text, job.time);
+        if (key == "space")
+        {
+            float space = 0.0f;
+            if (!readFloat(text, space) || space != (float)(int)space || space < MODEL_SPACE || space > CLIP_SPACE)
+                return false;
+            job.space = (int)space;
+            return true;
+        }
+        return false;
+    }
+}
+
+glm::mat4 batchView(const BatchJob& job)
+{
+    return glm::lookAt(job.eye, job.target, job.up);
+}
+
+glm::mat4 batchProjection(const BatchJob& job, int width, int height)
+{
+    return glm::perspective(glm::radians(job.fov), (float)width / (float)height, job.nearPlane, job.farPlane);
+}
+
+bool loadBatchJobs(const std::string& path, const SceneLayout& scene, std::vector<BatchJob>& jobs)
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        std::cout << "ERROR::BATCH::CANNOT_READ " << path << std::endl;
+        return false;
+    }
+
+    // The scene camera: on the z axis, looking at the origin
+    BatchJob defaults;
+    defaults.eye = glm::vec3(0.0f, 0.0f, scene.viewDistance);
+    defaults.farPlane = sceneFarPlane(scene);
+
+    jobs.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line))
+    {
+        ++lineNumber;
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream fields(line);
+        std::string field;
+        BatchJob job = defaults;
+        bool empty = true;
+        while (fields >> field)
+        {
+            empty = false;
+            const size_t equals = field.find('=');
+            if (equals == std::string::npos || !readField(field.substr(0, equals), field.substr(equals + 1), job))
+            {
+                std::cout << "ERROR::BATCH::BAD_FIELD " << path << ":" << lineNumber << " " << field << std::endl;
+                return false;
+            }
+        }
+        if (empty)
+            continue;
+        if (job.farPlane <= job.nearPlane || glm::length(job.target - job.eye) == 0.0f)
+        {
+            std::cout << "ERROR::BATCH::BAD_CAMERA " << path << ":" << lineNumber << std::endl;
+            return false;
+        }
+        job.index = (int)jobs.size();
+        jobs.push_back(job);
+    }
+
+    if (jobs.empty())
+    {
+        std::cout << "ERROR::BATCH::NO_JOBS " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool BatchRun::init(const Options& options, const SceneLayout& scene)
+{
+    std::vector<BatchJob> all;
+    if (!loadBatchJobs(options.batchPath, scene, all))
+        return false;
+
+    // Shards take every shardCount-th job, so a slow stretch of the list is spread over all of them
+    shardIndex = options.shardIndex;
+    shardCount = options.shardCount;
+    jobs.clear();
+    for (const BatchJob& job : all)
+    {
+        if (job.index % shardCount == shardIndex)
+            jobs.push_back(job);
+    }
+
+    jobResults.assign(jobs.size(), BatchJobResult{ 0, 0, 0, 0 });
+    for (size_t k = 0; k < jobs.size(); ++k)
+        jobResults[k].index = jobs[k].index;
+    return true;
+}
+
+void BatchRun::started(size_t k, std::chrono::steady_clock::time_point when)
+{
+    jobResults[k].startNs = toNanoseconds(when);
+}
+
+void BatchRun::written(int index, bool ok)
+{
+    // Job indices are consecutive over the whole list, so this shard's k-th job is k * shardCount + shardIndex
+    BatchJobResult& result = jobResults[(size_t)((index - shardIndex) / shardCount)];
+    result.written = ok ? 1 : 0;
+    result.doneNs = toNanoseconds(std::chrono::steady_clock::now());
+}
+
+void writeBatchSummary(std::ostream& out, const std::vector<BatchJobResult>& results, int processes, double wallMs)
+{
+    std::vector<double> latencies;
+    latencies.reserve(results.size());
+    int64_t firstStart = INT64_MAX;
+    int64_t lastDone = INT64_MIN;
+    for (const BatchJobResult& result : results)
+    {
+        if (!result.written)
+            continue;
+        latencies.push_back((double)(result.doneNs - result.startNs) / 1e6);
+        firstStart = std::min(firstStart, result.startNs);
+        lastDone = std::max(lastDone, result.doneNs);
+    }
+    const size_t written = latencies.size();
+    const double activeMs = written > 0 ? (double)(lastDone - firstStart) / 1e6 : 0.0;
+
+    out << "{ \"jobs\": " << results.size()
+        << ", \"written\": " << written
+        << ", \"failed\": " << results.size() - written
+        << ", \"processes\": " << processes
+        << ", \"wall_ms\": " << wallMs
+        << ", \"render_ms\": " << activeMs
+        << ", \"renders_per_second\": " << (activeMs > 0.0 ? (double)written * 1000.0 / activeMs : 0.0)
+        << ", \"wall_renders_per_second\": " << (wallMs > 0.0 ? (double)written * 1000.0 / wallMs : 0.0)
+        << ", \"latency_ms\": ";
+    writeTimingSummary(out, summarize(latencies));
+    out << " }";
+}
@@ -0,0 +1,89 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "scene.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct Options;
+
+// One render of a batch: the scene drawn from its own camera, with its own object rotation
+struct BatchJob
+{
+    int index = 0;                  // position in the job list; numbers the output image
+    glm::vec3 eye = glm::vec3(0.0f);
+    glm::vec3 target = glm::vec3(0.0f);
+    glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
+    float fov = 45.0f;              // vertical field of view in degrees
+    float nearPlane = SCENE_NEAR_PLANE;
+    float farPlane = 100.0f;
+    float spin = 0.0f;              // rotation of every object in radians
+    float time = 0.0f;              // shader time
+    int space = MODEL_SPACE;        // coordinate space of the shader variant
+};
+
+glm::mat4 batchView(const BatchJob& job);
+glm::mat4 batchProjection(const BatchJob& job, int width, int height);
+
+// Read a job list: one job per line as key=value pairs, '#' starts a comment.
+//   eye=X,Y,Z target=X,Y,Z up=X,Y,Z fov=DEGREES near=N far=F spin=RADIANS time=SECONDS space=0-3
+// Keys left out keep the scene camera's value. Blank lines are skipped, so a job with the
+// default view needs at least one field, e.g. spin=0.
+bool loadBatchJobs(const std::string& path, const SceneLayout& scene, std::vector<BatchJob>& jobs);
+
+// Outcome of one job. Times are steady_clock nanoseconds, which is CLOCK_MONOTONIC on
+// Linux, so results from worker processes can be compared with each other.
+struct BatchJobResult
+{
+    int32_t index;
+    int32_t written;                // 1 once its image is on disk
+    int64_t startNs;                // simulation of the job began
+    int64_t doneNs;                 // its image was written
+};
+
+// The share of a job list this process renders (--shard), and when each job started and
+// finished. Jobs start on the simulating thread and finish on the capture encoders.
+class BatchRun
+{
+public:
+    bool init(const Options& options, const SceneLayout& scene);
+
+    bool active() const { return !jobs.empty(); }
+    size_t size() const { return jobs.size(); }
+    const BatchJob& operator[](size_t k) const { return jobs[k]; }
+
+    void started(size_t k, std::chrono::steady_clock::time_point when);
+    // Capture callback: frames are numbered by job index
+    void written(int index, bool ok);
+
+    // Complete once the capture has finished
+    const std::vector<BatchJobResult>& results() const { return jobResults; }
+
+private:
+    std::vector<BatchJob> jobs;
+    std::vector<BatchJobResult> jobResults;
+    int shardIndex = 0;
+    int shardCount = 1;
+};
+
+// Renders per second and latency over the results of one or more processes, as a JSON object.
+// wallMs is the whole run including start-up; the rate is taken from the first job's start
+// to the last image written.
+void writeBatchSummary(std::ostream& out, const std::vector<BatchJobResult>& results, int processes, double wallMs);
+
+// --batch-processes: fork one worker per process, each with its own context and a slice of
+// the jobs. In the parent this waits for the workers, reports the aggregate and returns true
+// with the exit code in result. In a worker it returns false with options narrowed to the
+// worker's shard, and the worker renders as usual and reports through options.batchReportFd.
+bool runBatchFarm(Options& options, int& result);
+
+// Worker side: send the results to the parent
+bool sendBatchResults(int fd, const std::vector<BatchJobResult>& results);
+
+#endif
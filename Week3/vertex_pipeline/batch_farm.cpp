@@ -0,0 +1,188 @@
+#include "batch.h"
+#include "options.h"
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    struct Worker
+    {
+        pid_t pid = -1;
+        int fd = -1;                // read end of the worker's result pipe
+        size_t received = 0;
+        int exitCode = -1;
+    };
+
+    // Read one result, riding out short reads and signals; false at the end of the stream
+    bool readResult(int fd, BatchJobResult& result)
+    {
+        size_t got = 0;
+        while (got < sizeof(result))
+        {
+            const ssize_t n = read(fd, (char*)&result + got, sizeof(result) - got);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            got += (size_t)n;
+        }
+        return true;
+    }
+}
+
+bool sendBatchResults(int fd, const std::vector<BatchJobResult>& results)
+{
+    const char* data = (const char*)results.data();
+    size_t left = results.size() * sizeof(BatchJobResult);
+    while (left > 0)
+    {
+        const ssize_t n = write(fd, data, left);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            std::cout << "ERROR::BATCH::CANNOT_REPORT" << std::endl;
+            return false;
+        }
+        data += n;
+        left -= (size_t)n;
+    }
+    return true;
+}
+
+bool runBatchFarm(Options& options, int& result)
+{
+    // The parent never opens a context; it only needs the job count to spot lost jobs
+    std::vector<BatchJob> jobs;
+    if (!loadBatchJobs(options.batchPath, buildScene(options.objects), jobs))
+    {
+        result = -1;
+        return true;
+    }
+
+    // Fork before any thread or context exists, so each worker starts from a clean process.
+    // Flush first, or each worker would print whatever was still buffered again.
+    std::fflush(nullptr);
+    const int processes = options.batchProcesses;
+    const auto wallStart = std::chrono::steady_clock::now();
+    std::vector<Worker> workers(processes);
+    for (int i = 0; i < processes; ++i)
+    {
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            std::cout << "ERROR::BATCH::PIPE_FAILED" << std::endl;
+            break;
+        }
+        const pid_t pid = fork();
+        if (pid == 0)
+        {
+            // Worker: this process's slice of the shard it was given, its own output files
+            for (int j = 0; j < i; ++j)
+                close(workers[j].fd);
+            close(fds[0]);
+            options.shardIndex = options.shardIndex * processes + i;
+            options.shardCount *= processes;
+            options.batchProcesses = 1;
+            options.batchReportFd = fds[1];
+            // Share the cores rather than give every worker a pool the size of the machine
+            const int hardwareThreads = std::max(1, (int)std::thread::hardware_concurrency());
+            if (options.threads == 0)
+                options.threads = std::max(1, hardwareThreads / processes);
+            if (options.captureThreads == 0)
+                options.captureThreads = std::max(1, hardwareThreads / 2 / processes);
+            const std::string suffix = ".worker" + std::to_string(i);
+            if (!options.outputPath.empty())
+                options.outputPath += suffix;
+            if (!options.tracePath.empty())
+                options.tracePath += suffix;
+            return false;
+        }
+        close(fds[1]);
+        if (pid < 0)
+        {
+            std::cout << "ERROR::BATCH::FORK_FAILED" << std::endl;
+            close(fds[0]);
+            break;
+        }
+        workers[i].pid = pid;
+        workers[i].fd = fds[0];
+    }
+
+    // Workers send their results once their last image is written. Reading the pipes in turn
+    // cannot deadlock: a worker blocked on a full pipe holds nothing another worker waits for.
+    std::vector<BatchJobResult> results;
+    results.reserve(jobs.size());
+    bool failed = false;
+    for (Worker& worker : workers)
+    {
+        if (worker.pid < 0)
+        {
+            failed = true;
+            continue;
+        }
+        BatchJobResult jobResult;
+        while (readResult(worker.fd, jobResult))
+        {
+            results.push_back(jobResult);
+            ++worker.received;
+        }
+        close(worker.fd);
+
+        int status = 0;
+        while (waitpid(worker.pid, &status, 0) < 0 && errno == EINTR)
+            ;
+        worker.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        if (worker.exitCode != 0)
+            failed = true;
+    }
+    const double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // Jobs whose worker died before reporting count as failed
+    size_t expected = 0;
+    for (const BatchJob& job : jobs)
+    {
+        if (job.index % options.shardCount == options.shardIndex)
+            ++expected;
+    }
+    while (results.size() < expected)
+        results.push_back(BatchJobResult{ -1, 0, 0, 0 });
+
+    std::ostringstream summary;
+    writeBatchSummary(summary, results, processes, wallMs);
+    std::ostringstream json;
+    json << "{\n  \"batch\": " << summary.str() << ",\n  \"workers\": [\n";
+    for (int i = 0; i < processes; ++i)
+    {
+        json << "    { \"pid\": " << workers[i].pid
+             << ", \"results\": " << workers[i].received
+             << ", \"exit_code\": " << workers[i].exitCode << " }" << (i + 1 < processes ? "," : "") << "\n";
+    }
+    json << "  ]\n}";
+
+    if (options.outputPath.empty())
+    {
+        std::cout << json.str() << std::endl;
+    }
+    else
+    {
+        std::ofstream file(options.outputPath);
+        if (!file)
+            std::cout << "ERROR::BENCHMARK::CANNOT_WRITE " << options.outputPath << std::endl;
+        else
+            file << json.str() << std::endl;
+    }
+    result = failed ? -1 : 0;
+    return true;
+}
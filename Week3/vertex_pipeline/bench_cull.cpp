@@ -0,0 +1,81 @@
+#include "benchmarks.h"
+#include "culling.h"
+#include "job_system.h"
+#include "options.h"
+#include "timing.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int runCullBenchmark(const Options& options)
+{
+    const size_t count = options.benchSize > 0 ? (size_t)options.benchSize : 1000000;
+    const double minSeconds = 0.5;
+
+    // Spheres scattered through a box around the camera, so a good share of them is visible
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> coord(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> size(0.5f, 3.0f);
+    BoundingSpheres spheres;
+    spheres.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        spheres.set(i, glm::vec3(coord(rng), coord(rng), coord(rng)), size(rng));
+
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 150.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)options.width / (float)options.height, 0.1f, 400.0f);
+    Frustum frustum = extractFrustum(projection * view);
+
+    std::vector<uint32_t> reference(count);
+    size_t referenceVisible = cullSpheres(TransformKernel::Scalar, frustum, spheres, 0, count, reference.data());
+
+    JobSystem jobs(options.threads);
+    std::vector<uint32_t> visible(count);
+
+    std::cout << "{\n"
+              << "  \"benchmark\": \"cull\",\n"
+              << "  \"objects\": " << count << ",\n"
+              << "  \"visible\": " << referenceVisible << ",\n"
+              << "  \"threads\": " << jobs.threadCount() << ",\n"
+              << "  \"kernels\": [\n";
+
+    const TransformKernel kernels[] = { TransformKernel::Scalar, TransformKernel::SSE4, TransformKernel::AVX2, TransformKernel::AVX512 };
+    bool first = true;
+    bool allValid = true;
+    for (TransformKernel kernel : kernels)
+    {
+        if (!kernelSupported(kernel))
+            continue;
+
+        // Both the single and multithreaded paths must keep exactly the scalar result
+        size_t serialVisible = cullSpheres(kernel, frustum, spheres, 0, count, visible.data());
+        bool valid = serialVisible == referenceVisible &&
+                     std::equal(reference.begin(), reference.begin() + referenceVisible, visible.begin());
+        size_t parallelVisible = cullSpheres(jobs, kernel, frustum, spheres, visible);
+        valid = valid && parallelVisible == referenceVisible &&
+                std::equal(reference.begin(), reference.begin() + referenceVisible, visible.begin());
+        allValid = allValid && valid;
+
+        double serialMs = millisecondsPerCall(minSeconds, [&]() {
+            cullSpheres(kernel, frustum, spheres, 0, count, visible.data());
+        });
+        double parallelMs = millisecondsPerCall(minSeconds, [&]() {
+            cullSpheres(jobs, kernel, frustum, spheres, visible);
+        });
+
+        std::cout << (first ? "" : ",\n")
+                  << "    { \"kernel\": \"" << kernelName(kernel) << "\", "
+                  << "\"valid\": " << (valid ? "true" : "false") << ", "
+                  << "\"single_thread_ms\": " << serialMs << ", "
+                  << "\"parallel_ms\": " << parallelMs << ", "
+                  << "\"mobjects_per_sec\": " << (double)count / parallelMs / 1000.0 << " }";
+        first = false;
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+
+    return allValid ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+#include "benchmarks.h"
+#include "culling.h"
+#include "job_system.h"
+#include "options.h"
+#include "render_queue.h"
+#include "scene.h"
+#include "timing.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+int runJobsBenchmark(const Options& options)
+{
+    const size_t count = options.benchSize > 0 ? (size_t)options.benchSize : 1000000;
+    const size_t tinyJobs = 100000;
+    const double minSeconds = 0.3;
+
+    // 1, 2, 4, ... 64 threads (or up to --threads); counts past the hardware threads
+    // show what oversubscription costs
+    const int maxThreads = options.threads > 0 ? options.threads : 64;
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    // Objects scattered around the camera, as in the cull benchmark
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> coord(-200.0f, 200.0f);
+    std::vector<glm::vec3> positions(count);
+    BoundingSpheres spheres;
+    spheres.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        positions[i] = glm::vec3(coord(rng), coord(rng), coord(rng));
+        spheres.set(i, positions[i], 1.0f);
+    }
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 150.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)options.width / (float)options.height, 0.1f, 400.0f);
+    const Frustum frustum = extractFrustum(projection * view);
+    const TransformKernel kernel = bestKernel();
+
+    std::vector<glm::mat4> models(count);
+    std::vector<uint32_t> visible(count);
+    std::vector<DrawItem> keys(count);
+
+    std::cout << "{\n"
+              << "  \"benchmark\": \"jobs\",\n"
+              << "  \"objects\": " << count << ",\n"
+              << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+              << "  \"cull_kernel\": \"" << kernelName(kernel) << "\",\n"
+              << "  \"runs\": [\n";
+
+    double baseTransformMs = 0.0, baseCullMs = 0.0, baseFrameMs = 0.0;
+    for (size_t run = 0; run < threadCounts.size(); ++run)
+    {
+        JobSystem jobs(threadCounts[run]);
+        const size_t grain = jobs.grainFor(count, 1024);
+
+        // Model matrices for every object
+        double transformMs = millisecondsPerCall(minSeconds, [&]() {
+            jobs.parallelFor(0, count, grain, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i)
+                    models[i] = objectModel(positions[i], 0.5f);
+            });
+        });
+
+        // Frustum culling with the best SIMD kernel
+        double cullMs = millisecondsPerCall(minSeconds, [&]() {
+            cullSpheres(jobs, kernel, frustum, spheres, visible);
+        });
+
+        // A frame's worth of dependent stages: models and culling run side by side, and
+        // sort keys for the survivors are built once culling is done
+        double frameMs = millisecondsPerCall(minSeconds, [&]() {
+            JobCounter modelsDone, culled, keysDone;
+            size_t visibleCount = 0;
+            jobs.parallelFor(0, count, grain, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i)
+                    models[i] = objectModel(positions[i], 0.5f);
+            }, &modelsDone);
+            jobs.submit([&]() { visibleCount = cullSpheres(jobs, kernel, frustum, spheres, visible); }, &culled);
+            jobs.then(culled, [&]() {
+                jobs.parallelFor(0, visibleCount, jobs.grainFor(visibleCount, 1024), [&](size_t first, size_t last) {
+                    for (size_t k = first; k < last; ++k)
+                    {
+                        float distance = -(view * glm::vec4(positions[visible[k]], 1.0f)).z;
+                        keys[k] = DrawItem{ makeSortKey(PASS_OPAQUE, 0, 0, 0, quantizeDepth(distance, 0.1f, 400.0f)), (uint32_t)k };
+                    }
+                }, &keysDone);
+            }, &keysDone);
+            jobs.wait(modelsDone);
+            jobs.wait(keysDone);
+        });
+
+        // Scheduling overhead: many jobs that do next to nothing
+        double tinyMs = millisecondsPerCall(minSeconds, [&]() {
+            JobCounter done;
+            std::atomic<uint64_t> sum{ 0 };
+            for (size_t i = 0; i < tinyJobs; ++i)
+                jobs.submit([&sum, i]() { sum.fetch_add(i, std::memory_order_relaxed); }, &done);
+            jobs.wait(done);
+        });
+
+        if (run == 0)
+        {
+            baseTransformMs = transformMs;
+            baseCullMs = cullMs;
+            baseFrameMs = frameMs;
+        }
+
+        std::cout << "    { \"threads\": " << jobs.threadCount()
+                  << ", \"transform_ms\": " << transformMs
+                  << ", \"transform_speedup\": " << baseTransformMs / transformMs
+                  << ", \"cull_ms\": " << cullMs
+                  << ", \"cull_speedup\": " << baseCullMs / cullMs
+                  << ", \"frame_graph_ms\": " << frameMs
+                  << ", \"frame_graph_speedup\": " << baseFrameMs / frameMs
+                  << ", \"ns_per_tiny_job\": " << tinyMs * 1.0e6 / (double)tinyJobs << " }"
+                  << (run + 1 < threadCounts.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "benchmarks.h"
+#include "options.h"
+#include "render_queue.h"
+#include "timing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // What a scene would hand the queue for one draw
+    struct DrawDesc
+    {
+        uint32_t pass;
+        uint32_t program;
+        uint32_t vertexArray;
+        uint32_t material;
+        float distance;
+    };
+}
+
+int runQueueBenchmark(const Options& options)
+{
+    const size_t count = options.benchSize > 0 ? (size_t)options.benchSize : 100000;
+    const double minSeconds = 0.5;
+    const float nearPlane = 0.1f;
+    const float farPlane = 500.0f;
+
+    // A mixed scene in arbitrary submission order: a few programs and vertex arrays,
+    // many materials, one draw in ten transparent
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<uint32_t> program(0, 15);
+    std::uniform_int_distribution<uint32_t> vertexArray(0, 7);
+    std::uniform_int_distribution<uint32_t> material(0, 255);
+    std::uniform_real_distribution<float> distance(nearPlane, farPlane);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<DrawDesc> draws(count);
+    for (DrawDesc& draw : draws)
+    {
+        draw.pass = percent(rng) < 10 ? PASS_TRANSPARENT : PASS_OPAQUE;
+        draw.program = program(rng);
+        draw.vertexArray = vertexArray(rng);
+        draw.material = material(rng);
+        draw.distance = distance(rng);
+    }
+
+    RenderQueue queue;
+    queue.reserve(count);
+    auto record = [&]() {
+        queue.clear();
+        for (size_t i = 0; i < count; ++i)
+        {
+            const DrawDesc& draw = draws[i];
+            uint32_t depth = quantizeDepth(draw.distance, nearPlane, farPlane, draw.pass == PASS_TRANSPARENT);
+            queue.push(makeSortKey(draw.pass, draw.program, draw.vertexArray, draw.material, depth), (uint32_t)i);
+        }
+    };
+
+    // The radix sort must give exactly the order of a stable comparison sort
+    record();
+    const size_t unsortedChanges = countStateChanges(queue);
+    std::vector<DrawItem> expected(queue.begin(), queue.end());
+    std::stable_sort(expected.begin(), expected.end(), [](const DrawItem& a, const DrawItem& b) { return a.key < b.key; });
+    queue.sort();
+    bool valid = std::equal(queue.begin(), queue.end(), expected.begin(),
+                            [](const DrawItem& a, const DrawItem& b) { return a.key == b.key && a.payload == b.payload; });
+    const size_t sortedChanges = countStateChanges(queue);
+    const int passes = queue.lastSortPasses();
+
+    std::vector<DrawItem> comparison(count);
+    double recordMs = millisecondsPerCall(minSeconds, record);
+    double radixMs = millisecondsPerCall(minSeconds, [&]() {
+        record();
+        queue.sort();
+    }) - recordMs;
+    double comparisonMs = millisecondsPerCall(minSeconds, [&]() {
+        record();
+        comparison.assign(queue.begin(), queue.end());
+        std::sort(comparison.begin(), comparison.end(), [](const DrawItem& a, const DrawItem& b) { return a.key < b.key; });
+    }) - recordMs;
+
+    std::cout << "{\n"
+              << "  \"benchmark\": \"queue\",\n"
+              << "  \"draws\": " << count << ",\n"
+              << "  \"valid\": " << (valid ? "true" : "false") << ",\n"
+              << "  \"radix_passes\": " << passes << ",\n"
+              << "  \"state_changes_unsorted\": " << unsortedChanges << ",\n"
+              << "  \"state_changes_sorted\": " << sortedChanges << ",\n"
+              << "  \"record_ms\": " << recordMs << ",\n"
+              << "  \"radix_sort_ms\": " << radixMs << ",\n"
+              << "  \"std_sort_ms\": " << comparisonMs << ",\n"
+              << "  \"mdraws_per_sec\": " << (double)count / (recordMs + radixMs) / 1000.0 << "\n"
+              << "}" << std::endl;
+
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+#include "benchmark.h"
+#include "benchmarks.h"
+#include "job_system.h"
+#include "mesh.h"
+#include "options.h"
+#include "scene.h"
+#include "software_rasterizer.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    // Objects cycle through the meshes in multi-draw mode, like the GL path
+    std::vector<int> assignMeshes(const Options& options, MeshRegistry& meshes, size_t objects)
+    {
+        meshes.add(makeCube());
+        std::vector<int> objectMeshes;
+        if (options.multiDraw)
+        {
+            meshes.add(makePyramid());
+            meshes.add(makeOctahedron());
+            objectMeshes.resize(objects);
+            for (size_t i = 0; i < objects; ++i)
+                objectMeshes[i] = (int)(i % (size_t)meshes.count());
+        }
+        return objectMeshes;
+    }
+}
+
+int runSoftwareHeadless(const Options& options)
+{
+    JobSystem jobs(options.threads);
+    SceneLayout scene = buildScene(options.objects);
+    MeshRegistry meshes;
+    std::vector<int> objectMeshes = assignMeshes(options, meshes, scene.positions.size());
+    const bool instanced = options.instanced || options.multiDraw;
+
+    SoftwareRasterizer raster(jobs);
+    raster.resize((int)options.width, (int)options.height);
+
+    BenchmarkRecorder recorder;
+    recorder.reserve(options.frames);
+    auto runStart = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < options.frames; ++frame)
+    {
+        TRACE_SCOPE("frame");
+        auto frameStart = std::chrono::steady_clock::now();
+        renderSceneSoftware(raster, scene, meshes, objectMeshes, WORLD_SPACE, instanced, (float)frame / 60.0f);
+        recorder.addFrame(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+    const RasterStats& stats = raster.stats();
+    std::ostringstream throughput;
+    throughput << "{ \"threads\": " << jobs.threadCount()
+               << ", \"triangles_per_sec\": " << (double)stats.trianglesIn / seconds
+               << ", \"pixels_per_sec\": " << (double)stats.fragments / seconds
+               << ", \"pixels_written_per_sec\": " << (double)stats.pixelsWritten / seconds << " }";
+    recorder.addSection("software", throughput.str());
+
+    std::string renderer = "software rasterizer";
+    if (options.outputPath.empty())
+    {
+        recorder.writeJson(std::cout, options, renderer, "cpu");
+    }
+    else
+    {
+        std::ofstream file(options.outputPath);
+        if (!file)
+        {
+            std::cout << "ERROR::BENCHMARK::CANNOT_WRITE " << options.outputPath << std::endl;
+            return -1;
+        }
+        recorder.writeJson(file, options, renderer, "cpu");
+    }
+    return 0;
+}
+
+int runRasterBenchmark(const Options& options)
+{
+    SceneLayout scene = buildScene(options.objects);
+    MeshRegistry meshes;
+    std::vector<int> objectMeshes = assignMeshes(options, meshes, scene.positions.size());
+    const bool instanced = options.instanced || options.multiDraw;
+    const double minSeconds = 1.0;
+
+    // 1, 2, 4, ... up to every hardware thread, plus the exact maximum
+    int maxThreads = options.threads > 0 ? options.threads : (int)std::thread::hardware_concurrency();
+    maxThreads = std::max(maxThreads, 1);
+    std::vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    std::cout << "{\n"
+              << "  \"benchmark\": \"raster\",\n"
+              << "  \"width\": " << options.width << ",\n"
+              << "  \"height\": " << options.height << ",\n"
+              << "  \"objects\": " << options.objects << ",\n"
+              << "  \"runs\": [\n";
+
+    double singleThreadRate = 0.0;
+    for (size_t run = 0; run < threadCounts.size(); ++run)
+    {
+        JobSystem jobs(threadCounts[run]);
+        SoftwareRasterizer raster(jobs);
+        raster.resize((int)options.width, (int)options.height);
+
+        // One untimed frame to size every scratch buffer
+        renderSceneSoftware(raster, scene, meshes, objectMeshes, WORLD_SPACE, instanced, 0.0f);
+        raster.resetStats();
+
+        int frames = 0;
+        auto start = std::chrono::steady_clock::now();
+        double seconds = 0.0;
+        do
+        {
+            renderSceneSoftware(raster, scene, meshes, objectMeshes, WORLD_SPACE, instanced, (float)frames / 60.0f);
+            ++frames;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < minSeconds);
+
+        const RasterStats& stats = raster.stats();
+        double triangleRate = (double)stats.trianglesIn / seconds;
+        if (run == 0)
+            singleThreadRate = triangleRate;
+
+        std::cout << "    { \"threads\": " << jobs.threadCount()
+                  << ", \"frames\": " << frames
+                  << ", \"ms_per_frame\": " << seconds * 1000.0 / frames
+                  << ", \"triangles_per_sec\": " << triangleRate
+                  << ", \"triangles_drawn_per_sec\": " << (double)stats.trianglesDrawn / seconds
+                  << ", \"pixels_per_sec\": " << (double)stats.fragments / seconds
+                  << ", \"pixels_written_per_sec\": " << (double)stats.pixelsWritten / seconds
+                  << ", \"speedup\": " << triangleRate / singleThreadRate << " }"
+                  << (run + 1 < threadCounts.size() ? "," : "") << "\n";
+    }
+    std::cout << "  ]\n}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include "benchmarks.h"
+#include "options.h"
+#include "shm_frame_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace
+{
+    // What the consumer process reports back through a pipe
+    struct ConsumerResult
+    {
+        uint64_t frames = 0;
+        uint64_t dropped = 0;
+        uint64_t torn = 0;
+        double latencySumMs = 0.0;
+        double latencyMaxMs = 0.0;
+        double seconds = 0.0;
+        uint64_t checksum = 0;
+    };
+
+    uint64_t sumWords(const uint8_t* data, size_t bytes)
+    {
+        const uint64_t* words = (const uint64_t*)data;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < bytes / sizeof(uint64_t); ++i)
+            sum += words[i];
+        return sum;
+    }
+
+    void addLatency(ConsumerResult& result, int64_t sentNs)
+    {
+        const double latencyMs = (double)(monotonicNanoseconds() - sentNs) / 1.0e6;
+        result.latencySumMs += latencyMs;
+        result.latencyMaxMs = std::max(result.latencyMaxMs, latencyMs);
+    }
+
+    bool readAll(int fd, void* data, size_t bytes)
+    {
+        uint8_t* out = (uint8_t*)data;
+        while (bytes > 0)
+        {
+            ssize_t got = read(fd, out, bytes);
+            if (got <= 0)
+                return false;
+            out += got;
+            bytes -= (size_t)got;
+        }
+        return true;
+    }
+
+    bool writeAll(int fd, const void* data, size_t bytes)
+    {
+        const uint8_t* in = (const uint8_t*)data;
+        while (bytes > 0)
+        {
+            ssize_t sent = send(fd, in, bytes, MSG_NOSIGNAL);
+            if (sent < 0 && errno == ENOTSOCK)
+                sent = write(fd, in, bytes);
+            if (sent <= 0)
+                return false;
+            in += sent;
+            bytes -= (size_t)sent;
+        }
+        return true;
+    }
+
+    // Consumer process reading the ring in place until the producer closes it
+    ConsumerResult consumeRing(const std::string& socketPath)
+    {
+        ConsumerResult result;
+        ShmFrameReader reader;
+        if (!reader.connect(socketPath))
+            return result;
+        auto start = std::chrono::steady_clock::now();
+        ShmFrameView view;
+        while (reader.acquire(view, 5000))
+        {
+            const uint64_t sum = sumWords(view.pixels, (size_t)view.stride * (size_t)view.height);
+            if (reader.release(view))
+            {
+                result.checksum ^= sum;
+                addLatency(result, view.publishedNs);
+            }
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.frames = reader.stats().frames;
+        result.dropped = reader.stats().dropped;
+        result.torn = reader.stats().torn;
+        return result;
+    }
+
+    // Consumer process receiving whole frames through a socket, the transfer the ring avoids
+    ConsumerResult consumeSocket(int fd, size_t frameBytes, int frames)
+    {
+        ConsumerResult result;
+        std::vector<uint8_t> frame(frameBytes);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i)
+        {
+            int64_t sentNs = 0;
+            if (!readAll(fd, &sentNs, sizeof(sentNs)) || !readAll(fd, frame.data(), frameBytes))
+                break;
+            result.checksum ^= sumWords(frame.data(), frameBytes);
+            addLatency(result, sentNs);
+            ++result.frames;
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+
+    void writeConsumer(std::ostream& out, const ConsumerResult& result, size_t frameBytes)
+    {
+        const uint64_t intact = result.frames - result.torn;
+        out << "\"consumer_frames\": " << result.frames
+            << ", \"consumer_fps\": " << (double)result.frames / result.seconds
+            << ", \"consumer_gb_per_s\": " << (double)result.frames * (double)frameBytes / result.seconds / 1.0e9
+            << ", \"mean_latency_ms\": " << (intact > 0 ? result.latencySumMs / (double)intact : 0.0)
+            << ", \"max_latency_ms\": " << result.latencyMaxMs;
+    }
+}
+
+int runShmBenchmark(const Options& options)
+{
+    const int frames = options.benchSize > 0 ? (int)options.benchSize : 600;
+    const int width = (int)options.width;
+    const int height = (int)options.height;
+    const size_t frameBytes = (size_t)width * (size_t)height * 4;
+
+    // A frame that changes every time so nothing can be cached away
+    std::vector<uint8_t> source(frameBytes);
+    for (size_t i = 0; i < frameBytes; ++i)
+        source[i] = (uint8_t)(i * 31);
+
+    // Shared-memory ring: the producer publishes as fast as it can and never waits, so a
+    // slower consumer skips frames rather than holding the producer up
+    const std::string socketPath = "/tmp/vertex_pipeline_shm_bench_" + std::to_string(getpid()) + ".sock";
+    ShmFrameWriter writer;
+    if (!writer.init(socketPath, width, height))
+        return -1;
+    int results[2];
+    if (pipe(results) != 0)
+        return -1;
+    pid_t consumer = fork();
+    if (consumer == 0)
+    {
+        ConsumerResult result = consumeRing(socketPath);
+        writeAll(results[1], &result, sizeof(result));
+        _exit(0);
+    }
+    // Keep publishing a warm-up frame until the consumer has the ring. A consumer that
+    // cannot connect exits without ever showing up, so stop when it does or time runs out.
+    const auto connectDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    bool consumerExited = false;
+    while (writer.stats().consumers == 0)
+    {
+        consumerExited = waitpid(consumer, nullptr, WNOHANG) == consumer;
+        if (consumerExited || std::chrono::steady_clock::now() > connectDeadline)
+        {
+            std::cout << "ERROR::SHM::CONSUMER_NEVER_CONNECTED" << (consumerExited ? " (consumer exited)" : " (timed out)") << std::endl;
+            writer.destroy();
+            if (!consumerExited)
+            {
+                kill(consumer, SIGKILL);
+                waitpid(consumer, nullptr, 0);
+            }
+            close(results[0]);
+            close(results[1]);
+            return -1;
+        }
+        writer.publish(-1, source.data(), false, monotonicNanoseconds());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const ShmWriterStats warmup = writer.stats();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i)
+    {
+        source[(size_t)i % frameBytes] ^= 0xff;
+        writer.publish(i, source.data(), false, monotonicNanoseconds());
+    }
+    const double shmSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double copyMs = writer.stats().copyMs - warmup.copyMs;
+    const uint64_t wakes = writer.stats().wakes - warmup.wakes;
+    writer.destroy();
+    ConsumerResult shmResult;
+    readAll(results[0], &shmResult, sizeof(shmResult));
+    waitpid(consumer, nullptr, 0);
+
+    // Socket baseline: every frame is copied into the kernel and out again
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+        return -1;
+    consumer = fork();
+    if (consumer == 0)
+    {
+        close(sockets[0]);
+        ConsumerResult result = consumeSocket(sockets[1], frameBytes, frames);
+        writeAll(results[1], &result, sizeof(result));
+        _exit(0);
+    }
+    close(sockets[1]);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frames; ++i)
+    {
+        source[(size_t)i % frameBytes] ^= 0xff;
+        const int64_t sentNs = monotonicNanoseconds();
+        if (!writeAll(sockets[0], &sentNs, sizeof(sentNs)) || !writeAll(sockets[0], source.data(), frameBytes))
+            break;
+    }
+    close(sockets[0]);
+    ConsumerResult socketResult;
+    readAll(results[0], &socketResult, sizeof(socketResult));
+    const double socketSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    waitpid(consumer, nullptr, 0);
+    close(results[0]);
+    close(results[1]);
+
+    std::cout << "{\n"
+              << "  \"benchmark\": \"shm\",\n"
+              << "  \"width\": " << width << ",\n"
+              << "  \"height\": " << height << ",\n"
+              << "  \"frame_bytes\": " << frameBytes << ",\n"
+              << "  \"frames\": " << frames << ",\n"
+              << "  \"shared_memory\": { \"slots\": " << ShmFrameWriter::SLOTS
+              << ", \"producer_fps\": " << (double)frames / shmSeconds
+              << ", \"producer_gb_per_s\": " << (double)frames * (double)frameBytes / shmSeconds / 1.0e9
+              << ", \"copy_ms_per_frame\": " << copyMs / (double)frames
+              << ", \"wakes\": " << wakes
+              << ", \"dropped\": " << shmResult.dropped
+              << ", \"torn\": " << shmResult.torn << ", ";
+    writeConsumer(std::cout, shmResult, frameBytes);
+    std::cout << " },\n"
+              << "  \"socket\": { \"producer_fps\": " << (double)frames / socketSeconds
+              << ", \"producer_gb_per_s\": " << (double)frames * (double)frameBytes / socketSeconds / 1.0e9 << ", ";
+    writeConsumer(std::cout, socketResult, frameBytes);
+    std::cout << " }\n}" << std::endl;
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "benchmarks.h"
+#include "options.h"
+#include "timing.h"
+#include "transform.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int runTransformBenchmark(const Options& options)
+{
+    // Default batch fits in L2 so the numbers reflect the kernels rather than DRAM
+    const size_t count = options.benchSize > 0 ? (size_t)options.benchSize : 16384;
+    const double minSeconds = 0.5;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(-1.0f, 1.0f);
+    SoAVertices positions;
+    positions.resize(count);
+    std::vector<glm::vec4> aos(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        positions.x[i] = coord(rng);
+        positions.y[i] = coord(rng);
+        positions.z[i] = coord(rng);
+        positions.w[i] = 1.0f;
+        aos[i] = glm::vec4(positions.x[i], positions.y[i], positions.z[i], 1.0f);
+    }
+    VertexStreamIn input = positions.in();
+    input.w = nullptr;
+
+    TransformMatrices matrices;
+    matrices.model = glm::rotate(glm::mat4(1.0f), 0.5f, glm::vec3(0.5f, 1.0f, 0.0f));
+    matrices.view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+    matrices.projection = glm::perspective(glm::radians(45.0f), (float)options.width / (float)options.height, 0.1f, 100.0f);
+
+    SoAVertices world, view, clip;
+    world.resize(count);
+    view.resize(count);
+    clip.resize(count);
+
+    // Baseline: the straightforward glm loop over an array of vec4
+    std::vector<glm::vec4> aosOut(count);
+    const glm::mat4 mvp = matrices.projection * matrices.view * matrices.model;
+    double glmRate = (double)count * 1000.0 / millisecondsPerCall(minSeconds, [&]() {
+        for (size_t i = 0; i < count; ++i)
+            aosOut[i] = mvp * aos[i];
+    });
+
+    std::cout << "{\n"
+              << "  \"benchmark\": \"transform\",\n"
+              << "  \"vertices\": " << count << ",\n"
+              << "  \"glm_mvertices_per_sec\": " << glmRate / 1.0e6 << ",\n"
+              << "  \"kernels\": [\n";
+
+    const TransformKernel kernels[] = { TransformKernel::Scalar, TransformKernel::SSE4, TransformKernel::AVX2, TransformKernel::AVX512 };
+    bool first = true;
+    bool allValid = true;
+    for (TransformKernel kernel : kernels)
+    {
+        if (!kernelSupported(kernel))
+            continue;
+
+        float error = validateKernel(kernel, 4099);
+        bool valid = error < 1.0e-5f;
+        allValid = allValid && valid;
+
+        SpaceOutputs clipOnly;
+        clipOnly.clip = clip.out();
+        double clipRate = (double)count * 1000.0 / millisecondsPerCall(minSeconds, [&]() {
+            transformPositions(kernel, matrices, input, clipOnly, count);
+        });
+
+        SpaceOutputs allSpaces;
+        allSpaces.world = world.out();
+        allSpaces.view = view.out();
+        allSpaces.clip = clip.out();
+        double chainRate = (double)count * 1000.0 / millisecondsPerCall(minSeconds, [&]() {
+            transformPositions(kernel, matrices, input, allSpaces, count);
+        });
+
+        std::cout << (first ? "" : ",\n")
+                  << "    { \"kernel\": \"" << kernelName(kernel) << "\", "
+                  << "\"valid\": " << (valid ? "true" : "false") << ", "
+                  << "\"max_relative_error\": " << error << ", "
+                  << "\"clip_mvertices_per_sec\": " << clipRate / 1.0e6 << ", "
+                  << "\"all_spaces_mvertices_per_sec\": " << chainRate / 1.0e6 << ", "
+                  << "\"speedup_vs_glm\": " << clipRate / glmRate << " }";
+        first = false;
+    }
+    std::cout << "\n  ]\n}" << std::endl;
+
+    return allValid ? 0 : 1;
+}
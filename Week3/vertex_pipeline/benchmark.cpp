@@ -0,0 +1,128 @@
+#include "benchmark.h"
+#include "options.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Nearest-rank percentile of an already sorted list
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t rank = (size_t)std::ceil(p / 100.0 * (double)sorted.size());
+    rank = std::min(std::max<size_t>(rank, 1), sorted.size());
+    return sorted[rank - 1];
+}
+
+TimingSummary summarize(std::vector<double> values)
+{
+    TimingSummary summary;
+    if (values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+    double total = 0.0;
+    for (double v : values)
+        total += v;
+
+    summary.samples = values.size();
+    summary.min = values.front();
+    summary.max = values.back();
+    summary.mean = total / (double)values.size();
+    summary.p50 = percentile(values, 50.0);
+    summary.p90 = percentile(values, 90.0);
+    summary.p95 = percentile(values, 95.0);
+    summary.p99 = percentile(values, 99.0);
+    return summary;
+}
+
+void BenchmarkRecorder::setGpuTime(int frame, double gpuMs)
+{
+    if (frame >= 0 && frame < (int)frames.size())
+        frames[frame].gpuMs = gpuMs;
+}
+
+void writeTimingSummary(std::ostream& out, const TimingSummary& s)
+{
+    out << "{ "
+        << "\"samples\": " << s.samples << ", "
+        << "\"min\": " << s.min << ", "
+        << "\"mean\": " << s.mean << ", "
+        << "\"p50\": " << s.p50 << ", "
+        << "\"p90\": " << s.p90 << ", "
+        << "\"p95\": " << s.p95 << ", "
+        << "\"p99\": " << s.p99 << ", "
+        << "\"max\": " << s.max << " }";
+}
+
+// Minimal escaping for driver strings and paths, which are plain ASCII in practice
+std::string jsonEscape(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if ((unsigned char)c >= 0x20) {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void BenchmarkRecorder::writeJson(std::ostream& out, const Options& options, const std::string& renderer, const std::string& version) const
+{
+    std::vector<double> cpu, gpu;
+    cpu.reserve(frames.size());
+    gpu.reserve(frames.size());
+    for (const FrameTiming& f : frames)
+    {
+        cpu.push_back(f.cpuMs);
+        if (f.gpuMs >= 0.0)
+            gpu.push_back(f.gpuMs);
+    }
+
+    out << "{\n"
+        << "  \"renderer\": \"" << jsonEscape(renderer) << "\",\n"
+        << "  \"version\": \"" << jsonEscape(version) << "\",\n"
+        << "  \"platform_version\": \"" << jsonEscape(platformVersion) << "\",\n"
+        << "  \"headless\": " << (options.headless ? "true" : "false") << ",\n"
+        << "  \"platform\": \"" << platformName(options.platform) << "\",\n"
+        << "  \"width\": " << options.width << ",\n"
+        << "  \"height\": " << options.height << ",\n"
+        << "  \"objects\": " << options.objects << ",\n"
+        << "  \"instanced\": " << (options.instanced ? "true" : "false") << ",\n"
+        << "  \"multi_draw\": " << (options.multiDraw ? "true" : "false") << ",\n"
+        << "  \"frames\": " << frames.size() << ",\n"
+        << "  \"startup_ms\": {\n"
+        << "    \"shaders\": " << startup.shaderMs << ",\n"
+        << "    \"shader_cache\": " << (startup.cacheEnabled ? "true" : "false") << ",\n"
+        << "    \"cache_hits\": " << startup.cacheHits << ",\n"
+        << "    \"cache_misses\": " << startup.cacheMisses << ",\n"
+        << "    \"cache_stale\": " << startup.cacheStale << ",\n"
+        << "    \"warm_load\": " << startup.warmLoadMs << ",\n"
+        << "    \"cold_compile\": " << startup.coldCompileMs << "\n"
+        << "  },\n"
+        << "  \"summary_ms\": {\n";
+    out << "    \"cpu\": ";
+    writeTimingSummary(out, summarize(cpu));
+    out << ",\n    \"gpu\": ";
+    writeTimingSummary(out, summarize(gpu));
+    out << "\n  },\n";
+    for (const auto& section : sections)
+        out << "  \"" << section.first << "\": " << section.second << ",\n";
+    out << "  \"frame_ms\": [\n";
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+        out << "    { \"cpu\": " << frames[i].cpuMs << ", \"gpu\": ";
+        if (frames[i].gpuMs >= 0.0)
+            out << frames[i].gpuMs;
+        else
+            out << "null";
+        out << " }" << (i + 1 < frames.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n"
+        << "}" << std::endl;
+}
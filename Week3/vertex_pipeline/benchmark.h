@@ -0,0 +1,76 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct Options;
+
+// Timing of a single frame in milliseconds. gpuMs is negative until the query result arrives.
+struct FrameTiming
+{
+    double cpuMs = 0.0;
+    double gpuMs = -1.0;
+};
+
+// Min/mean/percentiles over one column of frame timings
+struct TimingSummary
+{
+    double min = 0.0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+    size_t samples = 0;
+};
+
+TimingSummary summarize(std::vector<double> values);
+
+// Write a summary as a one-line JSON object
+void writeTimingSummary(std::ostream& out, const TimingSummary& summary);
+
+// Escapes quotes and backslashes and drops control characters, for strings written into JSON
+std::string jsonEscape(const std::string& text);
+
+// One-off costs paid before the first frame
+struct StartupStats
+{
+    double shaderMs = 0.0;          // total time to have every program ready
+    bool cacheEnabled = false;
+    int cacheHits = 0;
+    int cacheMisses = 0;
+    int cacheStale = 0;
+    double warmLoadMs = 0.0;        // programs loaded from cached binaries
+    double coldCompileMs = 0.0;     // programs compiled from source
+};
+
+// Collects per-frame timings and writes them out as JSON
+class BenchmarkRecorder
+{
+public:
+    void reserve(int count) { frames.reserve(count); }
+    void addFrame(double cpuMs) { frames.push_back(FrameTiming{ cpuMs, -1.0 }); }
+    void setGpuTime(int frame, double gpuMs);
+    int frameCount() const { return (int)frames.size(); }
+    void setStartup(const StartupStats& stats) { startup = stats; }
+    // Context API version reported beside the GL strings, e.g. "EGL 1.5 (Mesa Project)"
+    void setPlatformVersion(const std::string& version) { platformVersion = version; }
+
+    // Extra top-level JSON member; json must already be a valid value
+    void addSection(const std::string& name, const std::string& json) { sections.push_back({ name, json }); }
+
+    void writeJson(std::ostream& out, const Options& options, const std::string& renderer, const std::string& version) const;
+
+private:
+    std::vector<FrameTiming> frames;
+    StartupStats startup;
+    std::string platformVersion;
+    std::vector<std::pair<std::string, std::string>> sections;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+struct Options;
+
+// Offline benchmarks selected with --bench NAME. They need no window or GL context
+// and print their results as JSON. Each returns the process exit code.
+int runTransformBenchmark(const Options& options);
+int runRasterBenchmark(const Options& options);
+int runCullBenchmark(const Options& options);
+int runQueueBenchmark(const Options& options);
+int runJobsBenchmark(const Options& options);
+// Shared-memory frame ring against a socket, between two processes (Linux only)
+int runShmBenchmark(const Options& options);
+
+// Headless frame benchmark on the software rasterizer, without any GL context
+int runSoftwareHeadless(const Options& options);
+
+#endif
@@ -0,0 +1,147 @@
+#include "culling.h"
+#include "culling_kernels.h"
+#include "job_system.h"
+#include "trace.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+size_t cullSpheresScalar(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                         size_t first, size_t last, uint32_t* visible)
+{
+    size_t count = 0;
+    for (size_t i = first; i < last; ++i)
+    {
+        bool inside = true;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const float* p = planes + plane * 4;
+            inside &= p[0] * x[i] + p[1] * y[i] + p[2] * z[i] + p[3] >= -r[i];
+        }
+        visible[count] = (uint32_t)i;
+        count += inside ? 1 : 0;
+    }
+    return count;
+}
+
+// Builds without a given ISA get a stub that is never reached, since kernelSupported() says no
+#ifndef VP_HAVE_SSE4
+size_t cullSpheresSSE4(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                       size_t first, size_t last, uint32_t* visible)
+{
+    return cullSpheresScalar(planes, x, y, z, r, first, last, visible);
+}
+#endif
+#ifndef VP_HAVE_AVX2
+size_t cullSpheresAVX2(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                       size_t first, size_t last, uint32_t* visible)
+{
+    return cullSpheresScalar(planes, x, y, z, r, first, last, visible);
+}
+#endif
+#ifndef VP_HAVE_AVX512
+size_t cullSpheresAVX512(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                         size_t first, size_t last, uint32_t* visible)
+{
+    return cullSpheresScalar(planes, x, y, z, r, first, last, visible);
+}
+#endif
+
+Frustum extractFrustum(const glm::mat4& viewProjection)
+{
+    // Gribb/Hartmann: each plane is the last row of the matrix plus or minus another row
+    const glm::mat4 m = glm::transpose(viewProjection);
+    Frustum frustum;
+    frustum.planes[0] = m[3] + m[0];
+    frustum.planes[1] = m[3] - m[0];
+    frustum.planes[2] = m[3] + m[1];
+    frustum.planes[3] = m[3] - m[1];
+    frustum.planes[4] = m[3] + m[2];
+    frustum.planes[5] = m[3] - m[2];
+
+    // Normalize so plane distances are in world units and comparable with radii
+    for (glm::vec4& plane : frustum.planes)
+        plane /= glm::length(glm::vec3(plane));
+    return frustum;
+}
+
+void BoundingSpheres::resize(size_t count)
+{
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    radius.resize(count);
+}
+
+void BoundingSpheres::set(size_t index, const glm::vec3& center, float sphereRadius)
+{
+    x[index] = center.x;
+    y[index] = center.y;
+    z[index] = center.z;
+    radius[index] = sphereRadius;
+}
+
+float boundingRadius(const float* positions, size_t vertexCount)
+{
+    float radiusSquared = 0.0f;
+    for (size_t i = 0; i < vertexCount; ++i)
+    {
+        const float* p = positions + i * 3;
+        radiusSquared = std::max(radiusSquared, p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+    }
+    return std::sqrt(radiusSquared);
+}
+
+size_t cullSpheres(TransformKernel kernel, const Frustum& frustum, const BoundingSpheres& spheres,
+                   size_t first, size_t last, uint32_t* visible)
+{
+    const float* planes = glm::value_ptr(frustum.planes[0]);
+    const float* x = spheres.x.data();
+    const float* y = spheres.y.data();
+    const float* z = spheres.z.data();
+    const float* r = spheres.radius.data();
+    switch (kernel) {
+        case TransformKernel::SSE4:
+            return cullSpheresSSE4(planes, x, y, z, r, first, last, visible);
+        case TransformKernel::AVX2:
+            return cullSpheresAVX2(planes, x, y, z, r, first, last, visible);
+        case TransformKernel::AVX512:
+            return cullSpheresAVX512(planes, x, y, z, r, first, last, visible);
+        default:
+            return cullSpheresScalar(planes, x, y, z, r, first, last, visible);
+    }
+}
+
+size_t cullSpheres(JobSystem& jobs, TransformKernel kernel, const Frustum& frustum,
+                   const BoundingSpheres& spheres, std::vector<uint32_t>& visible)
+{
+    // Chunks big enough to amortize a job
+    const size_t count = spheres.size();
+    const size_t chunkSize = jobs.grainFor(count, 16384);
+    visible.resize(count);
+    if (count <= chunkSize)
+        return cullSpheres(kernel, frustum, spheres, 0, count, visible.data());
+
+    // Each chunk writes its survivors at the start of its own slice of visible
+    const size_t chunks = (count + chunkSize - 1) / chunkSize;
+    std::vector<size_t> chunkVisible(chunks);
+    jobs.parallelFor(0, count, chunkSize, [&](size_t first, size_t last) {
+        TRACE_SCOPE("cull chunk");
+        chunkVisible[first / chunkSize] = cullSpheres(kernel, frustum, spheres, first, last, visible.data() + first);
+    });
+
+    // Slide every slice down behind the previous one; destinations never pass their sources.
+    // A slice with nothing culled before it is already in place, and std::copy may not be
+    // asked to copy a range onto itself.
+    size_t total = chunkVisible[0];
+    for (size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+        const uint32_t* source = visible.data() + chunk * chunkSize;
+        if (total != chunk * chunkSize)
+            std::copy(source, source + chunkVisible[chunk], visible.data() + total);
+        total += chunkVisible[chunk];
+    }
+    return total;
+}
@@ -0,0 +1,46 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include "transform.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+
+// The six clip planes of a projection * view matrix in world space, normalized and
+// facing inwards: left, right, bottom, top, near, far.
+struct Frustum
+{
+    glm::vec4 planes[6];
+};
+
+Frustum extractFrustum(const glm::mat4& viewProjection);
+
+// World-space bounding spheres in structure-of-arrays form, one per object
+struct BoundingSpheres
+{
+    std::vector<float> x, y, z, radius;
+
+    void resize(size_t count);
+    size_t size() const { return x.size(); }
+    void set(size_t index, const glm::vec3& center, float sphereRadius);
+};
+
+// Radius of the smallest origin-centered sphere holding every xyz position
+float boundingRadius(const float* positions, size_t vertexCount);
+
+// Indices of the spheres in [first, last) that touch the frustum, in increasing order.
+// Uses the same ISA tiers as the transform kernels. Returns how many were written.
+size_t cullSpheres(TransformKernel kernel, const Frustum& frustum, const BoundingSpheres& spheres,
+                   size_t first, size_t last, uint32_t* visible);
+
+// Cull every sphere, split into chunks across the job system, and compact the result
+// into the front of visible (resized to spheres.size()). Returns the visible count.
+size_t cullSpheres(JobSystem& jobs, TransformKernel kernel, const Frustum& frustum,
+                   const BoundingSpheres& spheres, std::vector<uint32_t>& visible);
+
+#endif
@@ -0,0 +1,41 @@
+#include "culling_kernels.h"
+
+#include <immintrin.h>
+
+// Eight spheres per iteration, one FMA chain per plane.
+size_t cullSpheresAVX2(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                       size_t first, size_t last, uint32_t* visible)
+{
+    __m256 p[24];
+    for (int i = 0; i < 24; ++i)
+        p[i] = _mm256_set1_ps(planes[i]);
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+    size_t count = 0;
+    size_t i = first;
+    for (; i + 8 <= last; i += 8)
+    {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vz = _mm256_loadu_ps(z + i);
+        __m256 negR = _mm256_xor_ps(_mm256_loadu_ps(r + i), signBit);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const __m256* q = p + plane * 4;
+            __m256 distance = _mm256_fmadd_ps(q[0], vx, _mm256_fmadd_ps(q[1], vy, _mm256_fmadd_ps(q[2], vz, q[3])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negR, _CMP_GE_OQ));
+        }
+
+        // Write every lane's index and only advance past the visible ones; branch-free,
+        // since visibility in a random batch is not predictable
+        unsigned int bits = (unsigned int)_mm256_movemask_ps(inside);
+        for (int lane = 0; lane < 8; ++lane)
+        {
+            visible[count] = (uint32_t)(i + lane);
+            count += (bits >> lane) & 1;
+        }
+    }
+    return count + cullSpheresScalar(planes, x, y, z, r, i, last, visible + count);
+}
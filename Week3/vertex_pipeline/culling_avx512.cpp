@@ -0,0 +1,37 @@
+#include "culling_kernels.h"
+
+#include <immintrin.h>
+
+// Sixteen spheres per iteration. The plane tests produce a lane mask directly and
+// compress-store writes the surviving indices out without any branching.
+size_t cullSpheresAVX512(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                         size_t first, size_t last, uint32_t* visible)
+{
+    __m512 p[24];
+    for (int i = 0; i < 24; ++i)
+        p[i] = _mm512_set1_ps(planes[i]);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    size_t count = 0;
+    size_t i = first;
+    for (; i + 16 <= last; i += 16)
+    {
+        __m512 vx = _mm512_loadu_ps(x + i);
+        __m512 vy = _mm512_loadu_ps(y + i);
+        __m512 vz = _mm512_loadu_ps(z + i);
+        __m512 negR = _mm512_sub_ps(_mm512_setzero_ps(), _mm512_loadu_ps(r + i));
+
+        __mmask16 inside = 0xffff;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const __m512* q = p + plane * 4;
+            __m512 distance = _mm512_fmadd_ps(q[0], vx, _mm512_fmadd_ps(q[1], vy, _mm512_fmadd_ps(q[2], vz, q[3])));
+            inside = _mm512_mask_cmp_ps_mask(inside, distance, negR, _CMP_GE_OQ);
+        }
+
+        __m512i index = _mm512_add_epi32(_mm512_set1_epi32((int)i), lanes);
+        _mm512_mask_compressstoreu_epi32(visible + count, inside, index);
+        count += (size_t)__builtin_popcount((unsigned int)inside);
+    }
+    return count + cullSpheresScalar(planes, x, y, z, r, i, last, visible + count);
+}
@@ -0,0 +1,20 @@
+#ifndef CULLING_KERNELS_H
+#define CULLING_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Per-ISA sphere-versus-frustum kernels behind cullSpheres(), built like the transform kernels.
+// planes holds six (a, b, c, d) planes facing into the frustum. Every sphere in [first, last)
+// that is not fully behind some plane has its index appended to visible; returns how many.
+// visible must have room for last - first entries.
+size_t cullSpheresScalar(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                         size_t first, size_t last, uint32_t* visible);
+size_t cullSpheresSSE4(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                       size_t first, size_t last, uint32_t* visible);
+size_t cullSpheresAVX2(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                       size_t first, size_t last, uint32_t* visible);
+size_t cullSpheresAVX512(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                         size_t first, size_t last, uint32_t* visible);
+
+#endif
@@ -0,0 +1,40 @@
+#include "culling_kernels.h"
+
+#include <immintrin.h>
+
+// Four spheres per iteration; every lane's index is written and only the visible ones are kept.
+size_t cullSpheresSSE4(const float* planes, const float* x, const float* y, const float* z, const float* r,
+                       size_t first, size_t last, uint32_t* visible)
+{
+    __m128 p[24];
+    for (int i = 0; i < 24; ++i)
+        p[i] = _mm_set1_ps(planes[i]);
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+
+    size_t count = 0;
+    size_t i = first;
+    for (; i + 4 <= last; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        __m128 negR = _mm_xor_ps(_mm_loadu_ps(r + i), signBit);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            const __m128* q = p + plane * 4;
+            __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(q[0], vx), _mm_mul_ps(q[1], vy)),
+                                         _mm_add_ps(_mm_mul_ps(q[2], vz), q[3]));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negR));
+        }
+
+        unsigned int bits = (unsigned int)_mm_movemask_ps(inside);
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            visible[count] = (uint32_t)(i + lane);
+            count += (bits >> lane) & 1;
+        }
+    }
+    return count + cullSpheresScalar(planes, x, y, z, r, i, last, visible + count);
+}
@@ -0,0 +1,136 @@
+#include "file_watcher.h"
+
+#include <iostream>
+#include <system_error>
+
+#if defined(VP_HAVE_INOTIFY)
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <set>
+#endif
+
+#if defined(VP_HAVE_INOTIFY)
+
+bool FileWatcher::init(const std::vector<std::string>& paths)
+{
+    destroy();
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cout << "ERROR::WATCHER::INOTIFY_FAILED " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::set<std::filesystem::path> directories;
+    for (const std::string& path : paths)
+    {
+        std::error_code error;
+        std::filesystem::path file = std::filesystem::absolute(path, error);
+        files.push_back(file);
+        directories.insert(file.parent_path());
+    }
+    for (const std::filesystem::path& directory : directories)
+    {
+        if (inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0)
+        {
+            std::cout << "ERROR::WATCHER::CANNOT_WATCH " << directory << " " << std::strerror(errno) << std::endl;
+            destroy();
+            return false;
+        }
+    }
+    return true;
+}
+
+void FileWatcher::destroy()
+{
+    if (fd >= 0)
+        close(fd);
+    fd = -1;
+    files.clear();
+}
+
+bool FileWatcher::changed()
+{
+    if (fd < 0)
+        return false;
+
+    // Drain every queued event; an editor's save is often several of them
+    bool hit = false;
+    alignas(struct inotify_event) char buffer[16 * (sizeof(struct inotify_event) + NAME_MAX + 1)];
+    while (true)
+    {
+        const ssize_t length = read(fd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+        for (ssize_t offset = 0; offset < length;)
+        {
+            const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+            if (event->len == 0)
+                continue;
+            for (const std::filesystem::path& file : files)
+            {
+                if (file.filename() == event->name)
+                    hit = true;
+            }
+        }
+    }
+    return hit;
+}
+
+#else
+
+namespace
+{
+    std::filesystem::file_time_type modifiedTime(const std::filesystem::path& path)
+    {
+        std::error_code error;
+        const std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+        return error ? std::filesystem::file_time_type::min() : time;
+    }
+}
+
+bool FileWatcher::init(const std::vector<std::string>& paths)
+{
+    destroy();
+    for (const std::string& path : paths)
+    {
+        files.push_back(path);
+        modified.push_back(modifiedTime(path));
+    }
+    lastCheck = std::chrono::steady_clock::now();
+    return true;
+}
+
+void FileWatcher::destroy()
+{
+    files.clear();
+    modified.clear();
+}
+
+bool FileWatcher::changed()
+{
+    // Asking the file system for every file every frame is not free; four times a second is plenty
+    const auto now = std::chrono::steady_clock::now();
+    if (now - lastCheck < std::chrono::milliseconds(250))
+        return false;
+    lastCheck = now;
+
+    bool hit = false;
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const std::filesystem::file_time_type time = modifiedTime(files[i]);
+        if (time != modified[i])
+        {
+            modified[i] = time;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+#endif
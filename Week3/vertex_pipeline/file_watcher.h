@@ -0,0 +1,32 @@
+#ifndef FILE_WATCHER_H
+#define FILE_WATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Tells when any of a set of files has been written. On Linux the directories holding them
+// are watched with inotify, so a check is one non-blocking read. Watching the directory
+// rather than the file also catches editors that save by writing a new file and renaming it
+// over the old one. Elsewhere modification times are compared, at most a few times a second.
+class FileWatcher
+{
+public:
+    bool init(const std::vector<std::string>& paths);
+    void destroy();
+
+    // True when a watched file changed since the last call; never blocks
+    bool changed();
+
+private:
+    std::vector<std::filesystem::path> files;
+#if defined(VP_HAVE_INOTIFY)
+    int fd = -1;
+#else
+    std::vector<std::filesystem::file_time_type> modified;
+    std::chrono::steady_clock::time_point lastCheck;
+#endif
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "fixed_timestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const double TWO_PI = 6.283185307179586;
+    const double SPIN_RATE = 1.0;       // radians per second
+}
+
+SimState interpolateStates(const SimState& previous, const SimState& current, double alpha)
+{
+    SimState state;
+    state.time = previous.time + (current.time - previous.time) * alpha;
+    // step() wraps both angles together, so the difference never crosses the wrap
+    state.spin = previous.spin + (current.spin - previous.spin) * alpha;
+    return state;
+}
+
+FixedTimestep::FixedTimestep(double rate, int maxStepsPerAdvance)
+    : stepSeconds(1.0 / std::max(rate, 1.0)), maxSteps(std::max(maxStepsPerAdvance, 1))
+{
+}
+
+int FixedTimestep::advance(double elapsedSeconds)
+{
+    ++counters.advances;
+    accumulator += std::max(elapsedSeconds, 0.0);
+
+    int steps = 0;
+    while (accumulator >= stepSeconds)
+    {
+        if (steps == maxSteps)
+        {
+            // Too far behind to catch up this frame: keep the fraction, drop the rest
+            counters.droppedSteps += (uint64_t)(accumulator / stepSeconds);
+            accumulator = std::fmod(accumulator, stepSeconds);
+            break;
+        }
+        step();
+        accumulator -= stepSeconds;
+        ++steps;
+    }
+    return steps;
+}
+
+void FixedTimestep::step()
+{
+    previous = current;
+    current.time += stepSeconds;
+    current.spin += SPIN_RATE * stepSeconds;
+    if (current.spin >= TWO_PI)
+    {
+        current.spin -= TWO_PI;
+        previous.spin -= TWO_PI;
+    }
+    ++counters.steps;
+}
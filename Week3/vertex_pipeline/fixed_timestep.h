@@ -0,0 +1,58 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <cstdint>
+
+// Everything the simulation advances. Objects spin at a constant rate; the angle is kept
+// in [0, 2 pi) so it does not lose precision in long runs.
+struct SimState
+{
+    double time = 0.0;      // simulated seconds
+    double spin = 0.0;      // rotation angle of every object in radians
+};
+
+// Blend between two consecutive states, alpha in [0, 1]
+SimState interpolateStates(const SimState& previous, const SimState& current, double alpha);
+
+// How far the simulation got and what it had to give up
+struct SimStats
+{
+    uint64_t steps = 0;
+    uint64_t advances = 0;          // calls to advance(), i.e. frames
+    uint64_t droppedSteps = 0;      // steps skipped because a frame fell too far behind
+};
+
+// Fixed-timestep update loop. Real elapsed time goes into an accumulator and the state
+// advances in whole steps of 1 / rate seconds, so the simulation behaves the same at any
+// frame rate. Rendering shows the blend of the last two states by the leftover fraction
+// of a step, which keeps motion smooth when the frame and step rates do not line up.
+class FixedTimestep
+{
+public:
+    // maxStepsPerAdvance bounds the catch-up after a stall; the backlog beyond it is
+    // dropped rather than making the next frame slower still
+    explicit FixedTimestep(double rate = 120.0, int maxStepsPerAdvance = 8);
+
+    // Add elapsed real seconds and run every whole step they cover. Returns the steps run.
+    int advance(double elapsedSeconds);
+
+    // The state to render: previous blended towards current by the accumulator
+    SimState interpolated() const { return interpolateStates(previous, current, alpha()); }
+    double alpha() const { return accumulator / stepSeconds; }
+
+    const SimState& state() const { return current; }
+    double rate() const { return 1.0 / stepSeconds; }
+    const SimStats& stats() const { return counters; }
+
+private:
+    void step();
+
+    double stepSeconds;
+    int maxSteps;
+    double accumulator = 0.0;
+    SimState previous;
+    SimState current;
+    SimStats counters;
+};
+
+#endif
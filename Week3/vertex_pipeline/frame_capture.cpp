@@ -0,0 +1,245 @@
+#include "frame_capture.h"
+#include "image_writer.h"
+#include "timing.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+    // The pattern goes to snprintf as the format string, so it may hold exactly one %d or
+    // %0Nd for the frame number and otherwise only %% escapes
+    bool validFramePattern(const std::string& pattern)
+    {
+        int conversions = 0;
+        for (size_t i = 0; i < pattern.size(); ++i)
+        {
+            if (pattern[i] != '%')
+                continue;
+            if (++i < pattern.size() && pattern[i] == '%')
+                continue;
+            if (i < pattern.size() && pattern[i] == '0')
+            {
+                ++i;
+                while (i < pattern.size() && std::isdigit((unsigned char)pattern[i]))
+                    ++i;
+            }
+            if (i >= pattern.size() || pattern[i] != 'd')
+                return false;
+            ++conversions;
+        }
+        return conversions == 1;
+    }
+}
+
+bool FrameCapture::init(const std::string& path, int captureWidth, int captureHeight, int threads, int fps)
+{
+    const size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    if (extension == "png")
+        captureFormat = CAPTURE_PNG;
+    else if (extension == "ppm")
+        captureFormat = CAPTURE_PPM;
+    else if (extension == "y4m")
+        captureFormat = CAPTURE_Y4M;
+    else
+    {
+        std::cout << "ERROR::CAPTURE::UNKNOWN_FORMAT " << path << " (use .png, .ppm or .y4m)" << std::endl;
+        return false;
+    }
+
+    // Number the frames unless the path already says where the number goes
+    pattern = path;
+    if (captureFormat != CAPTURE_Y4M && path.find('%') == std::string::npos)
+        pattern = path.substr(0, dot) + "_%05d" + path.substr(dot);
+    if (captureFormat != CAPTURE_Y4M && !validFramePattern(pattern))
+    {
+        std::cout << "ERROR::CAPTURE::BAD_PATTERN " << path << " (one %d or %0Nd for the frame number; write a literal % as %%)" << std::endl;
+        return false;
+    }
+
+    std::error_code error;
+    const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+    if (!directory.empty())
+        std::filesystem::create_directories(directory, error);
+
+    width = captureWidth;
+    height = captureHeight;
+    if (captureFormat == CAPTURE_Y4M)
+    {
+        stream.open(path, std::ios::binary | std::ios::trunc);
+        if (!stream)
+        {
+            std::cout << "ERROR::CAPTURE::CANNOT_WRITE " << path << std::endl;
+            return false;
+        }
+        writeY4mHeader(stream, width, height, fps);
+    }
+
+    if (threads <= 0)
+        threads = std::max(1, (int)std::thread::hardware_concurrency() / 2);
+    // One more queue for the thread that calls finish(); the others are encoder threads
+    encoders.reset(new JobSystem(threads + 1));
+
+    const size_t frameBytes = (size_t)width * (size_t)height * 4;
+    for (int i = 0; i < IMAGES; ++i)
+    {
+        images.push_back(std::unique_ptr<Image>(new Image()));
+        images.back()->rgba.resize(frameBytes);
+        freeImages.push_back(images.back().get());
+    }
+
+    queueHandler = [this](const Readback& finished) { queueReadback(finished); };
+    return readback.init(width, height);
+}
+
+void FrameCapture::destroy()
+{
+    readback.destroy();
+    encoders.reset();
+    images.clear();
+    freeImages.clear();
+    if (stream.is_open())
+        stream.close();
+}
+
+void FrameCapture::readFrame(unsigned int fbo, int frameWidth, int frameHeight, int frame)
+{
+    if (frameWidth != width || frameHeight != height)
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        ++counters.skipped;
+        return;
+    }
+
+    if (frame < 0 || captureFormat == CAPTURE_Y4M)
+        frame = nextFrame;
+    ++nextFrame;
+    readback.read(fbo, frame, queueHandler);
+}
+
+void FrameCapture::queueReadback(const Readback& finished)
+{
+    Image* image = acquireImage();
+    image->frame = finished.frame;
+
+    // GL rows run bottom-up; images are stored top row first
+    TRACE_SCOPE("capture copy");
+    auto copyStart = std::chrono::steady_clock::now();
+    const size_t rowBytes = (size_t)width * 4;
+    for (int y = 0; y < height; ++y)
+        std::memcpy(image->rgba.data() + (size_t)y * rowBytes, finished.pixels + (size_t)(height - 1 - y) * rowBytes, rowBytes);
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        ++counters.frames;
+        counters.copyMs += millisecondsSince(copyStart);
+    }
+
+    encoders->submit([this, image]() { encode(image); });
+}
+
+FrameCapture::Image* FrameCapture::acquireImage()
+{
+    std::unique_lock<std::mutex> lock(poolMutex);
+    if (freeImages.empty())
+    {
+        // Every image is queued for encoding: the encoders are behind, so wait rather than drop
+        TRACE_SCOPE("capture encoder wait");
+        auto waitStart = std::chrono::steady_clock::now();
+        imageFreed.wait(lock, [this]() { return !freeImages.empty(); });
+        ++counters.encoderWaits;
+        counters.waitMs += millisecondsSince(waitStart);
+    }
+    Image* image = freeImages.back();
+    freeImages.pop_back();
+    return image;
+}
+
+void FrameCapture::releaseImage(Image* image, bool written, size_t bytes, double encodeMs)
+{
+    if (writtenHandler)
+        writtenHandler(image->frame, written);
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (written)
+            ++counters.written;
+        else
+            ++counters.failed;
+        counters.bytes += bytes;
+        counters.encodeMs += encodeMs;
+        freeImages.push_back(image);
+    }
+    imageFreed.notify_one();
+}
+
+void FrameCapture::encode(Image* image)
+{
+    TRACE_SCOPE("capture encode");
+    auto encodeStart = std::chrono::steady_clock::now();
+    if (captureFormat == CAPTURE_Y4M)
+    {
+        rgbaToYuv420(image->rgba.data(), width, height, image->yuv);
+        appendToStream(image, millisecondsSince(encodeStart));
+        return;
+    }
+
+    const std::string path = framePath(image->frame);
+    const size_t bytes = captureFormat == CAPTURE_PNG ? writePng(path, image->rgba.data(), width, height)
+                                                      : writePpm(path, image->rgba.data(), width, height);
+    if (bytes == 0)
+        std::cout << "ERROR::CAPTURE::CANNOT_WRITE " << path << std::endl;
+    releaseImage(image, bytes > 0, bytes, millisecondsSince(encodeStart));
+}
+
+void FrameCapture::appendToStream(Image* image, double encodeMs)
+{
+    // Whichever encoder completes the next frame in sequence writes it and any that were
+    // waiting behind it
+    std::lock_guard<std::mutex> lock(streamMutex);
+    encodedFrames[image->frame] = std::make_pair(image, encodeMs);
+    while (!encodedFrames.empty() && encodedFrames.begin()->first == nextWrite)
+    {
+        auto next = encodedFrames.begin();
+        Image* ready = next->second.first;
+        auto writeStart = std::chrono::steady_clock::now();
+        stream << "FRAME\n";
+        stream.write((const char*)ready->yuv.data(), (std::streamsize)ready->yuv.size());
+        const bool written = (bool)stream;
+        releaseImage(ready, written, written ? ready->yuv.size() + 6 : 0, next->second.second + millisecondsSince(writeStart));
+        encodedFrames.erase(next);
+        ++nextWrite;
+    }
+}
+
+void FrameCapture::finish()
+{
+    if (!active())
+        return;
+    readback.drain(queueHandler);
+    encoders->wait();
+    if (stream.is_open())
+        stream.flush();
+}
+
+CaptureStats FrameCapture::stats()
+{
+    std::lock_guard<std::mutex> lock(poolMutex);
+    CaptureStats result = counters;
+    result.fenceWaits = readback.stats().fenceWaits;
+    result.waitMs += readback.stats().waitMs;
+    return result;
+}
+
+std::string FrameCapture::framePath(int frame) const
+{
+    char path[1024];
+    std::snprintf(path, sizeof(path), pattern.c_str(), frame);
+    return path;
+}
@@ -0,0 +1,112 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include "job_system.h"
+#include "readback_ring.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum CaptureFormat
+{
+    CAPTURE_PNG,
+    CAPTURE_PPM,
+    CAPTURE_Y4M
+};
+
+// Where the capture spent its time and whether it ever held the frame up
+struct CaptureStats
+{
+    uint64_t frames = 0;            // frames read back
+    uint64_t written = 0;           // frames encoded and written
+    uint64_t failed = 0;            // frames that could not be written
+    uint64_t skipped = 0;           // frames not at the capture size
+    uint64_t fenceWaits = 0;        // readbacks that waited for the GPU to finish an older one
+    uint64_t encoderWaits = 0;      // readbacks that waited for the encoders to free an image
+    double waitMs = 0.0;            // total time the GL thread spent in those waits
+    double copyMs = 0.0;            // total time copying finished readbacks out
+    double encodeMs = 0.0;          // total encode and write time over all encoder threads
+    uint64_t bytes = 0;             // bytes written
+};
+
+// Captures the scene to disk without stalling the frame. Frames come back through a
+// ReadbackRing; each finished readback is copied out and encoded and written on a pool of
+// encoder threads. Only when the GPU or the encoders fall a whole ring behind does the GL
+// thread wait, and it never drops a frame.
+class FrameCapture
+{
+public:
+    static const int IMAGES = 8;            // frames read back and waiting for the encoders
+
+    // path selects the format by extension. PNG and PPM write one file per frame: a printf
+    // pattern such as "shots/frame_%05d.png", or "frame.png" numbered as frame_00000.png.
+    // Y4M writes every frame into the one file. threads <= 0 uses half the hardware threads.
+    bool init(const std::string& path, int width, int height, int threads, int fps);
+    // Finish first; frees the pack buffers
+    void destroy();
+
+    bool active() const { return readback.active(); }
+
+    // Queue a readback of the color attachment of fbo, and hand earlier readbacks that the
+    // GPU has finished to the encoders. Frames of another size than init()'s are skipped.
+    // frame numbers the image; by default frames are numbered in the order they are read.
+    // Y4M always writes them in read order.
+    void readFrame(unsigned int fbo, int width, int height, int frame = -1);
+
+    // Called on an encoder thread once each frame has been written, or has failed to be
+    using WrittenHandler = std::function<void(int frame, bool written)>;
+    void setWrittenHandler(WrittenHandler handler) { writtenHandler = handler; }
+
+    // Wait until every queued frame has been written
+    void finish();
+
+    CaptureFormat format() const { return captureFormat; }
+    CaptureStats stats();
+
+private:
+    struct Image
+    {
+        int frame = -1;
+        std::vector<uint8_t> rgba;      // top row first
+        std::vector<uint8_t> yuv;       // Y4M only
+    };
+
+    void queueReadback(const Readback& finished);
+    Image* acquireImage();
+    void releaseImage(Image* image, bool written, size_t bytes, double encodeMs);
+    void encode(Image* image);
+    void appendToStream(Image* image, double encodeMs);
+    std::string framePath(int frame) const;
+
+    CaptureFormat captureFormat = CAPTURE_PNG;
+    std::string pattern;
+    int width = 0;
+    int height = 0;
+    ReadbackRing readback;
+    ReadbackHandler queueHandler;
+    WrittenHandler writtenHandler;
+    int nextFrame = 0;
+
+    std::unique_ptr<JobSystem> encoders;
+    std::vector<std::unique_ptr<Image>> images;
+    std::vector<Image*> freeImages;
+    std::mutex poolMutex;
+    std::condition_variable imageFreed;
+    CaptureStats counters;
+
+    // Y4M frames finish encoding out of order and are appended in order
+    std::ofstream stream;
+    std::mutex streamMutex;
+    std::map<int, std::pair<Image*, double>> encodedFrames;
+    int nextWrite = 0;
+};
+
+#endif
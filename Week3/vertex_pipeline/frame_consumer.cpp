@@ -0,0 +1,92 @@
+// Reference consumer for --shm-output. Maps the renderer's shared-memory frame ring and
+// reads every frame in place, without copying it out, then prints what it saw as JSON.
+//
+//   vp_frame_consumer SOCKET [--frames N] [--dump FILE.ppm]
+
+#include "image_writer.h"
+#include "shm_frame_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "Usage: " << argv[0] << " SOCKET [--frames N] [--dump FILE.ppm]\n"
+                  << "  SOCKET        the path given to vertex_pipeline --shm-output\n"
+                  << "  --frames N    stop after N frames (default: until the renderer exits)\n"
+                  << "  --dump FILE   write the last frame read as a PPM" << std::endl;
+        return -1;
+    }
+    const std::string socketPath = argv[1];
+    long maxFrames = 0;
+    std::string dumpPath;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            maxFrames = std::strtol(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+            dumpPath = argv[++i];
+        else
+        {
+            std::cout << "ERROR::CONSUMER::INVALID_ARGUMENT " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    ShmFrameReader reader;
+    if (!reader.connect(socketPath))
+        return -1;
+    const ShmRingHeader& ring = reader.header();
+    std::cerr << "Mapped " << ring.width << "x" << ring.height << " ring of " << ring.slotCount << " slots" << std::endl;
+
+    // Touch every pixel, as a real consumer would, and check the frame survived it
+    uint64_t checksum = 0;
+    double latencySumMs = 0.0, latencyMaxMs = 0.0;
+    int64_t firstFrame = -1, lastFrame = -1;
+    auto start = std::chrono::steady_clock::now();
+    ShmFrameView view;
+    while ((maxFrames <= 0 || (long)reader.stats().frames < maxFrames) && reader.acquire(view, 5000))
+    {
+        const size_t words = (size_t)view.stride * (size_t)view.height / sizeof(uint64_t);
+        const uint64_t* data = (const uint64_t*)view.pixels;
+        uint64_t sum = 0;
+        for (size_t i = 0; i < words; ++i)
+            sum += data[i];
+
+        const bool last = maxFrames > 0 && (long)reader.stats().frames == maxFrames;
+        if (last && !dumpPath.empty())
+            writePpm(dumpPath, view.pixels, view.width, view.height);
+
+        if (reader.release(view))
+        {
+            checksum ^= sum;
+            const double latencyMs = (double)(monotonicNanoseconds() - view.renderedNs) / 1.0e6;
+            latencySumMs += latencyMs;
+            latencyMaxMs = std::max(latencyMaxMs, latencyMs);
+            if (firstFrame < 0)
+                firstFrame = view.frame;
+            lastFrame = view.frame;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const ShmReaderStats& stats = reader.stats();
+    const uint64_t intact = stats.frames - stats.torn;
+    std::cout << "{ \"frames\": " << stats.frames
+              << ", \"dropped\": " << stats.dropped
+              << ", \"torn\": " << stats.torn
+              << ", \"first_frame\": " << firstFrame
+              << ", \"last_frame\": " << lastFrame
+              << ", \"fps\": " << (double)stats.frames / seconds
+              << ", \"gb_per_s\": " << (double)stats.frames * (double)ring.stride * (double)ring.height / seconds / 1.0e9
+              << ", \"mean_latency_ms\": " << (intact > 0 ? latencySumMs / (double)intact : 0.0)
+              << ", \"max_latency_ms\": " << latencyMaxMs
+              << ", \"checksum\": " << checksum << " }" << std::endl;
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifndef FRAME_PACKET_H
+#define FRAME_PACKET_H
+
+#include "indirect_draw.h"
+#include "render_queue.h"
+
+#include <glm/glm.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Everything the render side needs to draw one frame, produced by the simulation side.
+// Packets hold no GL objects, so they can be built on a thread without the context.
+// The vectors are reused from frame to frame.
+struct FramePacket
+{
+    int frame = 0;
+    bool quit = false;                      // no frame: the consumer stops here
+    int job = -1;                           // --batch job drawn; numbers its captured image
+
+    float time = 0.0f;                      // simulated seconds, interpolated to this frame
+    float spin = 0.0f;                      // object rotation at that time
+    int space = 0;                          // CoordinateSpace of the shader variant
+    int width = 0;                          // scene target size the camera was set up for
+    int height = 0;
+    glm::mat4 view = glm::mat4(1.0f);
+    glm::mat4 projection = glm::mat4(1.0f);
+
+    // Survivors of frustum culling. Without culling every object is visible and
+    // visibleObjects is not filled.
+    bool culled = false;
+    size_t visibleCount = 0;
+    std::vector<uint32_t> visibleObjects;
+
+    // Draw data for whichever path the scene uses
+    std::vector<glm::mat4> instanceTransforms;      // instanced: placements of the survivors
+    IndirectDrawList drawList;                      // multi-draw: one command per mesh run
+    RenderQueue drawQueue;                          // per-object: sorted draws...
+    std::vector<glm::mat4> drawModels;              // ...whose payload indexes these models
+
+    // When simulation of this frame began and how long it took, for latency measurements
+    std::chrono::steady_clock::time_point simulateStart;
+    double simulateMs = 0.0;
+};
+
+#endif
@@ -0,0 +1,163 @@
+#include "gl_call_stats.h"
+
+#ifdef VP_GL_CALL_STATS
+
+#include <glad/glad.h>
+
+#ifndef GLAD_DEBUG
+#error "VP_GL_CALL_STATS needs a glad loader generated with the C debug generator"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+    struct EntryPoint
+    {
+        const char* name;
+        GlCallCounts frame;
+        GlCallCounts total;
+    };
+
+    // glad passes the same name literal on every call, so the pointer identifies the
+    // entry point. Open addressing on it keeps the lookup to a hash and usually one compare.
+    const int TABLE_SIZE = 1024;            // power of two, well above the entry points in use
+    int table[TABLE_SIZE];
+    std::vector<EntryPoint> entries;
+
+    GlCallCounts frameCounts;
+    GlCallCounts lastFrame;
+    const char* lastTopName = "";
+    GlCallCounts lastTop;
+    uint64_t finishedFrames = 0;
+
+    const char* pendingName = nullptr;
+    std::chrono::steady_clock::time_point pendingStart;
+    thread_local bool ignoredThread = false;
+
+    EntryPoint& entryFor(const char* name)
+    {
+        uintptr_t key = (uintptr_t)name;
+        int slot = (int)(((key >> 3) * 0x9E3779B97F4A7C15ull) >> 54) & (TABLE_SIZE - 1);
+        while (table[slot] >= 0)
+        {
+            if (entries[table[slot]].name == name)
+                return entries[table[slot]];
+            slot = (slot + 1) & (TABLE_SIZE - 1);
+        }
+        table[slot] = (int)entries.size();
+        entries.push_back(EntryPoint{ name, GlCallCounts(), GlCallCounts() });
+        return entries.back();
+    }
+
+    void preCall(const char* name, void*, int, ...)
+    {
+        if (ignoredThread)
+            return;
+        pendingName = name;
+        pendingStart = std::chrono::steady_clock::now();
+    }
+
+    // Replaces glad's default post callback, which checks glGetError after every call and
+    // would add a round trip to each timing
+    void postCall(const char* name, void*, int, ...)
+    {
+        if (ignoredThread)
+            return;
+        auto end = std::chrono::steady_clock::now();
+        if (name != pendingName)
+            return;
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - pendingStart).count();
+        EntryPoint& entry = entryFor(name);
+        ++entry.frame.calls;
+        entry.frame.ns += ns;
+        ++frameCounts.calls;
+        frameCounts.ns += ns;
+        pendingName = nullptr;
+    }
+}
+
+void glCallStatsIgnoreThread()
+{
+    ignoredThread = true;
+}
+
+void glCallStatsInstall()
+{
+    std::fill(table, table + TABLE_SIZE, -1);
+    entries.reserve(TABLE_SIZE);
+    glad_set_pre_callback(preCall);
+    glad_set_post_callback(postCall);
+}
+
+void glCallStatsBeginFrame()
+{
+    frameCounts = GlCallCounts();
+    for (EntryPoint& entry : entries)
+        entry.frame = GlCallCounts();
+}
+
+void glCallStatsEndFrame()
+{
+    lastFrame = frameCounts;
+    lastTopName = "";
+    lastTop = GlCallCounts();
+    for (EntryPoint& entry : entries)
+    {
+        entry.total.calls += entry.frame.calls;
+        entry.total.ns += entry.frame.ns;
+        if (entry.frame.ns > lastTop.ns)
+        {
+            lastTopName = entry.name;
+            lastTop = entry.frame;
+        }
+    }
+    ++finishedFrames;
+}
+
+GlCallCounts glCallStatsLastFrame()
+{
+    return lastFrame;
+}
+
+const char* glCallStatsLastFrameTop(GlCallCounts& counts)
+{
+    counts = lastTop;
+    return lastTopName;
+}
+
+std::string glCallStatsSummaryJson()
+{
+    const double frames = (double)std::max<uint64_t>(finishedFrames, 1);
+    std::vector<const EntryPoint*> sorted;
+    GlCallCounts total;
+    for (const EntryPoint& entry : entries)
+    {
+        if (entry.total.calls == 0)
+            continue;
+        sorted.push_back(&entry);
+        total.calls += entry.total.calls;
+        total.ns += entry.total.ns;
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const EntryPoint* a, const EntryPoint* b) { return a->total.ns > b->total.ns; });
+
+    std::ostringstream json;
+    json << "{ \"frames\": " << finishedFrames
+         << ", \"calls_per_frame\": " << (double)total.calls / frames
+         << ", \"driver_ms_per_frame\": " << total.ms() / frames
+         << ", \"entry_points\": {";
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        json << (i ? "," : "") << "\n    \"" << sorted[i]->name << "\": { \"calls_per_frame\": "
+             << (double)sorted[i]->total.calls / frames << ", \"ms_per_frame\": " << sorted[i]->total.ms() / frames << " }";
+    }
+    json << "\n  } }";
+    return json.str();
+}
+
+#endif
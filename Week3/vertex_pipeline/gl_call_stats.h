@@ -0,0 +1,57 @@
+#ifndef GL_CALL_STATS_H
+#define GL_CALL_STATS_H
+
+#include <cstdint>
+#include <string>
+
+// GL calls issued and CPU time spent inside them
+struct GlCallCounts
+{
+    uint64_t calls = 0;
+    uint64_t ns = 0;
+
+    double ms() const { return (double)ns / 1.0e6; }
+};
+
+// Per entry point call counts and driver time, collected through the pre/post callbacks
+// of a glad loader generated with the C debug generator. Only builds configured with
+// VP_GL_CALL_STATS have them; everywhere else these are empty inline functions and glad
+// calls straight into the driver.
+//
+// Calls are only attributed to a frame between glCallStatsBeginFrame() and
+// glCallStatsEndFrame(). Only the thread that owns the context is counted; a thread working
+// on a shared context has to call glCallStatsIgnoreThread() before its first GL call.
+#ifdef VP_GL_CALL_STATS
+
+inline bool glCallStatsEnabled() { return true; }
+
+// Route every glad call through the counting callbacks
+void glCallStatsInstall();
+
+void glCallStatsBeginFrame();
+void glCallStatsEndFrame();
+
+// Leave the calling thread's GL calls out of the counts
+void glCallStatsIgnoreThread();
+
+// Totals of the last finished frame and the entry point that took longest in it
+GlCallCounts glCallStatsLastFrame();
+const char* glCallStatsLastFrameTop(GlCallCounts& counts);
+
+// Per frame averages over every finished frame: totals and each entry point, slowest first
+std::string glCallStatsSummaryJson();
+
+#else
+
+inline bool glCallStatsEnabled() { return false; }
+inline void glCallStatsInstall() {}
+inline void glCallStatsBeginFrame() {}
+inline void glCallStatsEndFrame() {}
+inline void glCallStatsIgnoreThread() {}
+inline GlCallCounts glCallStatsLastFrame() { return GlCallCounts(); }
+inline const char* glCallStatsLastFrameTop(GlCallCounts& counts) { counts = GlCallCounts(); return ""; }
+inline std::string glCallStatsSummaryJson() { return "{}"; }
+
+#endif
+
+#endif
@@ -0,0 +1,190 @@
+#include "gl_state.h"
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+GlState& glState()
+{
+    static GlState state;
+    return state;
+}
+
+GlState::GlState()
+{
+    invalidate();
+}
+
+void GlState::invalidate()
+{
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    for (unsigned int& buffer : buffers)
+        buffer = UNKNOWN;
+    for (UniformRange& range : uniformRanges)
+        range = UniformRange{ UNKNOWN, 0, 0 };
+    readFramebuffer = UNKNOWN;
+    drawFramebuffer = UNKNOWN;
+    activeUnit = -1;
+    for (unsigned int& texture : textures)
+        texture = UNKNOWN;
+    depthTest = -1;
+    blend = -1;
+    blendSource = UNKNOWN;
+    blendDestination = UNKNOWN;
+    clearColorKnown = false;
+    viewportKnown = false;
+}
+
+bool GlState::redundant(bool same)
+{
+    if (same) {
+        ++current.elided;
+        return true;
+    }
+    ++current.issued;
+    return false;
+}
+
+void GlState::beginFrame()
+{
+    current = GlStateStats();
+}
+
+void GlState::endFrame()
+{
+    totals.issued += current.issued;
+    totals.elided += current.elided;
+    previous = current;
+    ++frameCount;
+}
+
+void GlState::useProgram(unsigned int newProgram)
+{
+    if (redundant(program == newProgram))
+        return;
+    program = newProgram;
+    glUseProgram(newProgram);
+}
+
+void GlState::bindVertexArray(unsigned int vao)
+{
+    if (redundant(vertexArray == vao))
+        return;
+    vertexArray = vao;
+    glBindVertexArray(vao);
+}
+
+void GlState::bindBuffer(unsigned int target, unsigned int buffer)
+{
+    int slot;
+    switch (target) {
+    case GL_ARRAY_BUFFER:         slot = ARRAY_SLOT; break;
+    case GL_UNIFORM_BUFFER:       slot = UNIFORM_SLOT; break;
+    case GL_DRAW_INDIRECT_BUFFER: slot = INDIRECT_SLOT; break;
+    case GL_COPY_WRITE_BUFFER:    slot = COPY_WRITE_SLOT; break;
+    default:
+        ++current.issued;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (redundant(buffers[slot] == buffer))
+        return;
+    buffers[slot] = buffer;
+    glBindBuffer(target, buffer);
+}
+
+void GlState::bindUniformRange(int index, unsigned int buffer, size_t offset, size_t size)
+{
+    if (index < 0 || index >= UNIFORM_BINDINGS)
+    {
+        ++current.issued;
+        glBindBufferRange(GL_UNIFORM_BUFFER, (GLuint)index, buffer, (GLintptr)offset, (GLsizeiptr)size);
+        buffers[UNIFORM_SLOT] = buffer;
+        return;
+    }
+    UniformRange& range = uniformRanges[index];
+    if (redundant(range.buffer == buffer && range.offset == offset && range.size == size))
+        return;
+    range = UniformRange{ buffer, offset, size };
+    buffers[UNIFORM_SLOT] = buffer;
+    glBindBufferRange(GL_UNIFORM_BUFFER, (GLuint)index, buffer, (GLintptr)offset, (GLsizeiptr)size);
+}
+
+void GlState::bindFramebuffer(unsigned int target, unsigned int fbo)
+{
+    const bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    const bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    if (redundant((!read || readFramebuffer == fbo) && (!draw || drawFramebuffer == fbo)))
+        return;
+    if (read)
+        readFramebuffer = fbo;
+    if (draw)
+        drawFramebuffer = fbo;
+    glBindFramebuffer(target, fbo);
+}
+
+void GlState::bindTexture2D(int unit, unsigned int texture)
+{
+    if (redundant(textures[unit] == texture))
+        return;
+    if (activeUnit != unit)
+    {
+        ++current.issued;
+        activeUnit = unit;
+        glActiveTexture(GL_TEXTURE0 + (GLenum)unit);
+    }
+    textures[unit] = texture;
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GlState::setDepthTest(bool enabled)
+{
+    if (redundant(depthTest == (int)enabled))
+        return;
+    depthTest = enabled;
+    if (enabled)
+        glEnable(GL_DEPTH_TEST);
+    else
+        glDisable(GL_DEPTH_TEST);
+}
+
+void GlState::setBlend(bool enabled)
+{
+    if (redundant(blend == (int)enabled))
+        return;
+    blend = enabled;
+    if (enabled)
+        glEnable(GL_BLEND);
+    else
+        glDisable(GL_BLEND);
+}
+
+void GlState::blendFunc(unsigned int source, unsigned int destination)
+{
+    if (redundant(blendSource == source && blendDestination == destination))
+        return;
+    blendSource = source;
+    blendDestination = destination;
+    glBlendFunc(source, destination);
+}
+
+void GlState::clearColor(float r, float g, float b, float a)
+{
+    const float value[4] = { r, g, b, a };
+    if (redundant(clearColorKnown && std::memcmp(clearValue, value, sizeof(value)) == 0))
+        return;
+    clearColorKnown = true;
+    std::memcpy(clearValue, value, sizeof(value));
+    glClearColor(r, g, b, a);
+}
+
+void GlState::viewport(int x, int y, int width, int height)
+{
+    const int rect[4] = { x, y, width, height };
+    if (redundant(viewportKnown && std::memcmp(viewportRect, rect, sizeof(rect)) == 0))
+        return;
+    viewportKnown = true;
+    std::memcpy(viewportRect, rect, sizeof(rect));
+    glViewport(x, y, width, height);
+}
@@ -0,0 +1,96 @@
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// State changes sent to the driver and those skipped because the value was already current
+struct GlStateStats
+{
+    uint64_t issued = 0;
+    uint64_t elided = 0;
+};
+
+// Shadow copy of the GL state the renderer sets every frame: program, vertex array,
+// buffer bindings, framebuffers, depth test and blending, clear color, viewport and
+// 2D textures. Setting a value that is already current returns without calling GL.
+//
+// The shadow is only right while every change to these bindings goes through here.
+// Call invalidate() after anything else may have touched them (or deleted a bound
+// object whose name could be reused); the next call of each kind is then always issued.
+// Element array bindings belong to the vertex array and are deliberately not tracked.
+class GlState
+{
+public:
+    static const int TEXTURE_UNITS = 8;
+    static const int UNIFORM_BINDINGS = 8;
+
+    GlState();
+
+    void useProgram(unsigned int program);
+    void bindVertexArray(unsigned int vao);
+    // GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, GL_DRAW_INDIRECT_BUFFER and GL_COPY_WRITE_BUFFER are
+    // tracked; other targets are passed straight through
+    void bindBuffer(unsigned int target, unsigned int buffer);
+    // Indexed uniform buffer ranges; also moves the generic GL_UNIFORM_BUFFER binding
+    void bindUniformRange(int index, unsigned int buffer, size_t offset, size_t size);
+    // GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+    void bindFramebuffer(unsigned int target, unsigned int fbo);
+    void bindTexture2D(int unit, unsigned int texture);
+    void setDepthTest(bool enabled);
+    void setBlend(bool enabled);
+    void blendFunc(unsigned int source, unsigned int destination);
+    void clearColor(float r, float g, float b, float a);
+    void viewport(int x, int y, int width, int height);
+
+    // Forget everything; the next call of each kind goes to GL
+    void invalidate();
+
+    // Frame counters: calls outside begin/endFrame are not counted in any frame
+    void beginFrame();
+    void endFrame();
+    const GlStateStats& lastFrame() const { return previous; }
+    const GlStateStats& total() const { return totals; }
+    uint64_t frames() const { return frameCount; }
+
+private:
+    static const unsigned int UNKNOWN = 0xFFFFFFFFu;
+    enum BufferSlot { ARRAY_SLOT, UNIFORM_SLOT, INDIRECT_SLOT, COPY_WRITE_SLOT, BUFFER_SLOTS };
+
+    struct UniformRange
+    {
+        unsigned int buffer;
+        size_t offset;
+        size_t size;
+    };
+
+    // Counts the call and tells whether it can be skipped
+    bool redundant(bool same);
+
+    unsigned int program;
+    unsigned int vertexArray;
+    unsigned int buffers[BUFFER_SLOTS];
+    UniformRange uniformRanges[UNIFORM_BINDINGS];
+    unsigned int readFramebuffer;
+    unsigned int drawFramebuffer;
+    int activeUnit;
+    unsigned int textures[TEXTURE_UNITS];
+    int depthTest;                      // -1 = unknown
+    int blend;
+    unsigned int blendSource;
+    unsigned int blendDestination;
+    bool clearColorKnown;
+    float clearValue[4];
+    bool viewportKnown;
+    int viewportRect[4];
+
+    GlStateStats current;
+    GlStateStats previous;
+    GlStateStats totals;
+    uint64_t frameCount = 0;
+};
+
+// The state of the one context this program renders with
+GlState& glState();
+
+#endif
@@ -0,0 +1,138 @@
+#include "gpu_profiler.h"
+
+#include <sstream>
+
+void GpuProfiler::init()
+{
+    for (FrameSlot& slot : slots)
+    {
+        glGenQueries(2 + MAX_SCOPES * 2, slot.queries);
+        slot.pending = false;
+    }
+    current = 0;
+    recording = false;
+}
+
+void GpuProfiler::destroy()
+{
+    for (FrameSlot& slot : slots)
+        glDeleteQueries(2 + MAX_SCOPES * 2, slot.queries);
+}
+
+bool GpuProfiler::beginFrame(int frame)
+{
+    FrameSlot& slot = slots[current];
+    if (slot.pending)
+        return false;
+    slot.frame = frame;
+    slot.scopeCount = 0;
+    openScopes.clear();
+    recording = true;
+    glQueryCounter(slot.queries[0], GL_TIMESTAMP);
+    return true;
+}
+
+void GpuProfiler::endFrame()
+{
+    if (!recording)
+        return;
+    FrameSlot& slot = slots[current];
+    glQueryCounter(slot.queries[1], GL_TIMESTAMP);
+    slot.pending = true;
+    recording = false;
+    current = (current + 1) % LATENCY;
+}
+
+int GpuProfiler::findScope(const char* name)
+{
+    for (size_t i = 0; i < scopes.size(); ++i)
+    {
+        if (scopes[i].name == name)
+            return (int)i;
+    }
+    scopes.push_back(Scope());
+    scopes.back().name = name;
+    return (int)scopes.size() - 1;
+}
+
+void GpuProfiler::beginScope(const char* name)
+{
+    if (!recording)
+        return;
+    FrameSlot& slot = slots[current];
+    if (slot.scopeCount == MAX_SCOPES)
+    {
+        openScopes.push_back(-1);
+        return;
+    }
+    int index = slot.scopeCount++;
+    slot.scopeOf[index] = findScope(name);
+    openScopes.push_back(index);
+    glQueryCounter(slot.queries[2 + index * 2], GL_TIMESTAMP);
+}
+
+void GpuProfiler::endScope()
+{
+    if (!recording || openScopes.empty())
+        return;
+    int index = openScopes.back();
+    openScopes.pop_back();
+    if (index >= 0)
+        glQueryCounter(slots[current].queries[2 + index * 2 + 1], GL_TIMESTAMP);
+}
+
+double GpuProfiler::resolve(FrameSlot& slot)
+{
+    GLuint64 frameStart = 0, frameEnd = 0;
+    glGetQueryObjectui64v(slot.queries[0], GL_QUERY_RESULT, &frameStart);
+    glGetQueryObjectui64v(slot.queries[1], GL_QUERY_RESULT, &frameEnd);
+
+    // Add up repeated scopes before they go into the history
+    std::vector<double> frameMs(scopes.size(), -1.0);
+    for (int i = 0; i < slot.scopeCount; ++i)
+    {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(slot.queries[2 + i * 2], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(slot.queries[2 + i * 2 + 1], GL_QUERY_RESULT, &end);
+        double& ms = frameMs[slot.scopeOf[i]];
+        ms = (ms < 0.0 ? 0.0 : ms) + (double)(end - begin) / 1.0e6;
+    }
+    for (size_t s = 0; s < scopes.size(); ++s)
+    {
+        if (frameMs[s] < 0.0)
+            continue;
+        Scope& scope = scopes[s];
+        scope.samples.push_back(frameMs[s]);
+        scope.window[scope.windowNext] = frameMs[s];
+        scope.windowNext = (scope.windowNext + 1) % AVERAGE_FRAMES;
+        if (scope.windowCount < AVERAGE_FRAMES)
+            ++scope.windowCount;
+    }
+
+    slot.pending = false;
+    return (double)(frameEnd - frameStart) / 1.0e6;
+}
+
+double GpuProfiler::averageMs(int scope) const
+{
+    const Scope& s = scopes[scope];
+    if (s.windowCount == 0)
+        return 0.0;
+    double total = 0.0;
+    for (int i = 0; i < s.windowCount; ++i)
+        total += s.window[i];
+    return total / (double)s.windowCount;
+}
+
+std::string GpuProfiler::summaryJson() const
+{
+    std::ostringstream json;
+    json << "{";
+    for (size_t i = 0; i < scopes.size(); ++i)
+    {
+        json << (i ? "," : "") << "\n    \"" << scopes[i].name << "\": ";
+        writeTimingSummary(json, summarize(scopes[i].samples));
+    }
+    json << "\n  }";
+    return json.str();
+}
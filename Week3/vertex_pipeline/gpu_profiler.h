@@ -0,0 +1,93 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include "benchmark.h"
+
+#include <glad/glad.h>
+
+#include <string>
+#include <vector>
+
+// Per-pass GPU timings from GL_TIMESTAMP queries. Every frame stamps its start and end
+// and both ends of each named scope. Frames rotate through LATENCY sets of queries and
+// are only read back once the GPU has finished them, so collecting never stalls.
+class GpuProfiler
+{
+public:
+    static const int LATENCY = 3;           // frames in flight before a slot is reused
+    static const int MAX_SCOPES = 16;       // scopes per frame; extra scopes are not timed
+    static const int AVERAGE_FRAMES = 60;   // window of the rolling averages
+
+    void init();
+    void destroy();
+
+    // Returns false when the oldest frame is still in flight; that frame is simply not profiled
+    bool beginFrame(int frame);
+    void endFrame();
+
+    // Scopes may nest and repeat; repeated scopes in one frame add up. Only valid between
+    // beginFrame() and endFrame() of a profiled frame.
+    void beginScope(const char* name);
+    void endScope();
+
+    // Read back every finished frame; onFrame(frame, gpuMs) gets each frame's total.
+    // Pass wait = true at shutdown to drain the rest.
+    template <typename Callback>
+    void collect(bool wait, Callback onFrame);
+
+    int scopeCount() const { return (int)scopes.size(); }
+    const std::string& scopeName(int scope) const { return scopes[scope].name; }
+    double averageMs(int scope) const;
+
+    // JSON object with a timing summary of every scope over the whole run
+    std::string summaryJson() const;
+
+private:
+    struct Scope
+    {
+        std::string name;
+        std::vector<double> samples;    // one per profiled frame that used the scope
+        double window[AVERAGE_FRAMES] = {};
+        int windowCount = 0;
+        int windowNext = 0;
+    };
+
+    struct FrameSlot
+    {
+        unsigned int queries[2 + MAX_SCOPES * 2] = {};     // frame start, frame end, then scope pairs
+        int scopeOf[MAX_SCOPES] = {};
+        int scopeCount = 0;
+        int frame = 0;
+        bool pending = false;
+    };
+
+    int findScope(const char* name);
+    double resolve(FrameSlot& slot);
+
+    FrameSlot slots[LATENCY];
+    int current = 0;
+    bool recording = false;
+    std::vector<int> openScopes;        // scope slots begun but not ended, innermost last
+    std::vector<Scope> scopes;
+};
+
+template <typename Callback>
+void GpuProfiler::collect(bool wait, Callback onFrame)
+{
+    // Oldest first, so the rolling averages see frames in order
+    for (int n = 1; n <= LATENCY; ++n)
+    {
+        FrameSlot& slot = slots[(current + n) % LATENCY];
+        if (!slot.pending)
+            continue;
+
+        // Timestamps complete in order, so the frame end being ready means all of them are
+        int available = 0;
+        if (!wait)
+            glGetQueryObjectiv(slot.queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (wait || available)
+            onFrame(slot.frame, resolve(slot));
+    }
+}
+
+#endif
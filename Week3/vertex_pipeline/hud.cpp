@@ -0,0 +1,261 @@
+#include "hud.h"
+#include "gl_state.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+    // One glyph per printable ASCII code from space to underscore. Each byte is a row,
+    // top first, with the leftmost pixel in bit 4.
+    const int FIRST_GLYPH = 32;
+    const int GLYPH_COUNT = 64;
+    const unsigned char FONT[GLYPH_COUNT][Hud::GLYPH_HEIGHT] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },   // space
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 },   // !
+    { 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00 },   // "
+    { 0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a },   // #
+    { 0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04 },   // $
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 },   // %
+    { 0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d },   // &
+    { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 },   // quote
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 },   // (
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 },   // )
+    { 0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00 },   // *
+    { 0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00 },   // +
+    { 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08 },   // ,
+    { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00 },   // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c },   // .
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 },   // /
+    { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e },   // 0
+    { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e },   // 1
+    { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f },   // 2
+    { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e },   // 3
+    { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02 },   // 4
+    { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e },   // 5
+    { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e },   // 6
+    { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 },   // 7
+    { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e },   // 8
+    { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c },   // 9
+    { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00 },   // :
+    { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08 },   // ;
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 },   // <
+    { 0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00 },   // =
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 },   // >
+    { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 },   // ?
+    { 0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e },   // @
+    { 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 },   // A
+    { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e },   // B
+    { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e },   // C
+    { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c },   // D
+    { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f },   // E
+    { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10 },   // F
+    { 0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f },   // G
+    { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 },   // H
+    { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e },   // I
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c },   // J
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 },   // K
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f },   // L
+    { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11 },   // M
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 },   // N
+    { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e },   // O
+    { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10 },   // P
+    { 0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d },   // Q
+    { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11 },   // R
+    { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e },   // S
+    { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 },   // T
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e },   // U
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04 },   // V
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a },   // W
+    { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11 },   // X
+    { 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x04 },   // Y
+    { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f },   // Z
+    { 0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e },   // [
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 },   // backslash
+    { 0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e },   // ]
+    { 0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00 },   // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f },   // _
+    };
+
+    // Atlas layout: 16 cells per row with a pixel of padding so nearest filtering never
+    // bleeds between glyphs. The cell after the last glyph is solid, for boxes and bars.
+    const int CELL_WIDTH = Hud::GLYPH_WIDTH + 1;
+    const int CELL_HEIGHT = Hud::GLYPH_HEIGHT + 1;
+    const int ATLAS_COLUMNS = 16;
+    const int ATLAS_ROWS = (GLYPH_COUNT + 1 + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS;
+    const int ATLAS_WIDTH = ATLAS_COLUMNS * CELL_WIDTH;
+    const int ATLAS_HEIGHT = ATLAS_ROWS * CELL_HEIGHT;
+    const int SOLID_CELL = GLYPH_COUNT;
+
+    glm::vec4 cellUV(int cell)
+    {
+        float u0 = (float)((cell % ATLAS_COLUMNS) * CELL_WIDTH) / (float)ATLAS_WIDTH;
+        float v0 = (float)((cell / ATLAS_COLUMNS) * CELL_HEIGHT) / (float)ATLAS_HEIGHT;
+        return glm::vec4(u0, v0, u0 + (float)Hud::GLYPH_WIDTH / (float)ATLAS_WIDTH,
+                         v0 + (float)Hud::GLYPH_HEIGHT / (float)ATLAS_HEIGHT);
+    }
+
+    const char* hudVertexSource = R"(
+#version 330 core
+layout (location = 0) in vec4 rect;
+layout (location = 1) in vec4 uvRect;
+layout (location = 2) in vec4 color;
+
+uniform vec2 screenSize;
+
+out vec2 uv;
+out vec4 tint;
+
+void main()
+{
+    // Four-vertex strip per instance, corners generated from the vertex index
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 pixel = rect.xy + corner * rect.zw;
+    gl_Position = vec4(pixel.x / screenSize.x * 2.0 - 1.0, 1.0 - pixel.y / screenSize.y * 2.0, 0.0, 1.0);
+    uv = mix(uvRect.xy, uvRect.zw, corner);
+    tint = color;
+}
+)";
+
+    const char* hudFragmentSource = R"(
+#version 330 core
+in vec2 uv;
+in vec4 tint;
+out vec4 FragColor;
+
+uniform sampler2D atlas;
+
+void main()
+{
+    FragColor = vec4(tint.rgb, tint.a * texture(atlas, uv).r);
+}
+)";
+}
+
+bool Hud::init()
+{
+    program = compileProgram(hudVertexSource, hudFragmentSource);
+    if (!program)
+        return false;
+    screenSizeLoc = glGetUniformLocation(program, "screenSize");
+    glState().useProgram(program);
+    glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+
+    // Expand the font bits into a one-channel atlas
+    std::vector<unsigned char> pixels((size_t)ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+    for (int cell = 0; cell <= SOLID_CELL; ++cell)
+    {
+        int cellX = (cell % ATLAS_COLUMNS) * CELL_WIDTH;
+        int cellY = (cell / ATLAS_COLUMNS) * CELL_HEIGHT;
+        for (int row = 0; row < GLYPH_HEIGHT; ++row)
+        {
+            for (int column = 0; column < GLYPH_WIDTH; ++column)
+            {
+                bool set = cell == SOLID_CELL || (FONT[cell][row] >> (GLYPH_WIDTH - 1 - column)) & 1;
+                pixels[(size_t)(cellY + row) * ATLAS_WIDTH + cellX + column] = set ? 255 : 0;
+            }
+        }
+    }
+
+    glGenTextures(1, &atlas);
+    glState().bindTexture2D(0, atlas);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // Quads are pure per-instance data, read from the stream buffer; the corners come from gl_VertexID
+    glGenVertexArrays(1, &VAO);
+    glState().bindVertexArray(VAO);
+    for (int attribute = 0; attribute < 3; ++attribute)
+    {
+        glEnableVertexAttribArray((GLuint)attribute);
+        glVertexAttribDivisor((GLuint)attribute, 1);
+    }
+
+    quads.reserve(MAX_QUADS);
+    return true;
+}
+
+void Hud::destroy()
+{
+    glDeleteProgram(program);
+    glDeleteTextures(1, &atlas);
+    glDeleteVertexArrays(1, &VAO);
+}
+
+void Hud::begin(int width, int height)
+{
+    screenWidth = width;
+    screenHeight = height;
+    quads.clear();
+}
+
+void Hud::addQuad(const glm::vec4& rect, const glm::vec4& uv, const glm::vec4& color)
+{
+    if (quads.size() < (size_t)MAX_QUADS)
+        quads.push_back(Quad{ rect, uv, color });
+}
+
+float Hud::text(float x, float y, const char* text, const glm::vec4& color, float scale)
+{
+    for (const char* c = text; *c; ++c)
+    {
+        int code = std::toupper((unsigned char)*c) - FIRST_GLYPH;
+        if (code > 0 && code < GLYPH_COUNT)
+            addQuad(glm::vec4(x, y, GLYPH_WIDTH * scale, GLYPH_HEIGHT * scale), cellUV(code), color);
+        x += CELL_WIDTH * scale;
+    }
+    return x;
+}
+
+void Hud::rect(float x, float y, float width, float height, const glm::vec4& color)
+{
+    addQuad(glm::vec4(x, y, width, height), cellUV(SOLID_CELL), color);
+}
+
+void Hud::graph(float x, float y, float width, float height, const float* values, int count,
+                float maxValue, const glm::vec4& color)
+{
+    if (count <= 0 || maxValue <= 0.0f)
+        return;
+    float barWidth = width / (float)count;
+    for (int i = 0; i < count; ++i)
+    {
+        float barHeight = std::min(values[i] / maxValue, 1.0f) * height;
+        rect(x + barWidth * (float)i, y + height - barHeight, std::max(barWidth - 1.0f, 1.0f), barHeight, color);
+    }
+}
+
+void Hud::draw(StreamBuffer& stream)
+{
+    if (quads.empty())
+        return;
+
+    size_t offset = 0;
+    if (!stream.upload(quads.data(), quads.size() * sizeof(Quad), sizeof(glm::vec4), offset))
+        return;
+
+    GlState& state = glState();
+    state.bindVertexArray(VAO);
+    state.bindBuffer(GL_ARRAY_BUFFER, stream.handle());
+    for (int attribute = 0; attribute < 3; ++attribute)
+        glVertexAttribPointer((GLuint)attribute, 4, GL_FLOAT, GL_FALSE, sizeof(Quad), (void*)(offset + attribute * sizeof(glm::vec4)));
+
+    // Whoever draws next sets the state it needs, so nothing is restored afterwards
+    state.viewport(0, 0, screenWidth, screenHeight);
+    state.setDepthTest(false);
+    state.setBlend(true);
+    state.blendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    state.useProgram(program);
+    glUniform2f(screenSizeLoc, (float)screenWidth, (float)screenHeight);
+    state.bindTexture2D(0, atlas);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)quads.size());
+}
@@ -0,0 +1,61 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include "stream_buffer.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Screen-space overlay of text, boxes and graphs. Everything queued during a frame goes
+// out in one instanced draw of textured quads; glyphs come from a built-in 5x7 bitmap font
+// baked into a small atlas texture. Coordinates are pixels from the top-left corner.
+class Hud
+{
+public:
+    static const int MAX_QUADS = 8192;     // quads per frame; the rest are dropped
+    static const int GLYPH_WIDTH = 5;
+    static const int GLYPH_HEIGHT = 7;
+
+    bool init();
+    void destroy();
+
+    // Start a frame for a framebuffer of the given size
+    void begin(int width, int height);
+
+    // Draw text at scale pixels per font pixel. Lowercase letters use the uppercase glyphs.
+    // Returns the x just past the last character.
+    float text(float x, float y, const char* text, const glm::vec4& color, float scale = 2.0f);
+    void rect(float x, float y, float width, float height, const glm::vec4& color);
+
+    // Bar graph of count values, oldest first, scaled so maxValue fills the height
+    void graph(float x, float y, float width, float height, const float* values, int count,
+               float maxValue, const glm::vec4& color);
+
+    // Bytes of stream buffer a full frame of quads can need
+    static size_t streamBytes() { return MAX_QUADS * sizeof(Quad); }
+
+    // Upload everything queued since begin() into the stream buffer and draw it.
+    // Leaves depth testing disabled, blending on and the viewport at the full screen.
+    void draw(StreamBuffer& stream);
+
+private:
+    struct Quad
+    {
+        glm::vec4 rect;     // x, y, width, height in pixels
+        glm::vec4 uv;       // u0, v0, u1, v1 in the atlas
+        glm::vec4 color;
+    };
+
+    void addQuad(const glm::vec4& rect, const glm::vec4& uv, const glm::vec4& color);
+
+    unsigned int program = 0;
+    int screenSizeLoc = -1;
+    unsigned int atlas = 0;
+    unsigned int VAO = 0;
+    int screenWidth = 0;
+    int screenHeight = 0;
+    std::vector<Quad> quads;
+};
+
+#endif
@@ -0,0 +1,228 @@
+#include "image_writer.h"
+
+#include <algorithm>
+#include <fstream>
+
+#if defined(VP_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace
+{
+    struct CrcTable
+    {
+        uint32_t entries[256];
+
+        CrcTable()
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                entries[n] = c;
+            }
+        }
+    };
+
+    // PNG chunk CRC over the type and data
+    uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length)
+    {
+        static const CrcTable table;
+        for (size_t i = 0; i < length; ++i)
+            crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+        return crc;
+    }
+
+#if !defined(VP_HAVE_ZLIB)
+    uint32_t adler32(const uint8_t* data, size_t length)
+    {
+        uint32_t a = 1, b = 0;
+        while (length > 0)
+        {
+            // 5552 bytes is the most that can be summed before the 32-bit sums overflow
+            const size_t block = std::min<size_t>(length, 5552);
+            for (size_t i = 0; i < block; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += block;
+            length -= block;
+        }
+        return (b << 16) | a;
+    }
+#endif
+
+    void putBigEndian(std::vector<uint8_t>& out, uint32_t value)
+    {
+        out.push_back((uint8_t)(value >> 24));
+        out.push_back((uint8_t)(value >> 16));
+        out.push_back((uint8_t)(value >> 8));
+        out.push_back((uint8_t)value);
+    }
+
+    void putChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t length)
+    {
+        putBigEndian(out, (uint32_t)length);
+        const size_t typeStart = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data, data + length);
+        const uint32_t crc = crc32Update(0xffffffffu, out.data() + typeStart, length + 4) ^ 0xffffffffu;
+        putBigEndian(out, crc);
+    }
+
+    // zlib stream of the raw scanlines
+    bool deflateScanlines(const std::vector<uint8_t>& raw, std::vector<uint8_t>& out)
+    {
+#if defined(VP_HAVE_ZLIB)
+        uLongf length = compressBound((uLong)raw.size());
+        out.resize(length);
+        if (compress2(out.data(), &length, raw.data(), (uLong)raw.size(), Z_BEST_SPEED) != Z_OK)
+            return false;
+        out.resize(length);
+#else
+        // Stored blocks of at most 65535 bytes each
+        out.clear();
+        out.reserve(raw.size() + raw.size() / 65535 * 5 + 11);
+        out.push_back(0x78);
+        out.push_back(0x01);
+        size_t offset = 0;
+        do
+        {
+            const size_t length = std::min<size_t>(raw.size() - offset, 65535);
+            const bool last = offset + length == raw.size();
+            out.push_back(last ? 1 : 0);
+            out.push_back((uint8_t)length);
+            out.push_back((uint8_t)(length >> 8));
+            out.push_back((uint8_t)~length);
+            out.push_back((uint8_t)(~length >> 8));
+            out.insert(out.end(), raw.begin() + offset, raw.begin() + offset + length);
+            offset += length;
+        } while (offset < raw.size());
+        putBigEndian(out, adler32(raw.data(), raw.size()));
+#endif
+        return true;
+    }
+
+    size_t writeFile(const std::string& path, const uint8_t* data, size_t length)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.write((const char*)data, (std::streamsize)length))
+            return 0;
+        return length;
+    }
+
+    uint8_t clampByte(int value)
+    {
+        return (uint8_t)std::min(std::max(value, 0), 255);
+    }
+}
+
+size_t writePpm(const std::string& path, const uint8_t* rgba, int width, int height)
+{
+    const std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    std::vector<uint8_t> out(header.begin(), header.end());
+    out.reserve(header.size() + (size_t)width * (size_t)height * 3);
+    const size_t pixels = (size_t)width * (size_t)height;
+    for (size_t i = 0; i < pixels; ++i)
+        out.insert(out.end(), rgba + i * 4, rgba + i * 4 + 3);
+    return writeFile(path, out.data(), out.size());
+}
+
+size_t writePng(const std::string& path, const uint8_t* rgba, int width, int height)
+{
+    // Scanlines of RGB, each led by filter type 0 (none)
+    const size_t rowBytes = (size_t)width * 3 + 1;
+    std::vector<uint8_t> raw((size_t)height * rowBytes);
+    for (int y = 0; y < height; ++y)
+    {
+        uint8_t* row = raw.data() + (size_t)y * rowBytes;
+        const uint8_t* source = rgba + (size_t)y * (size_t)width * 4;
+        row[0] = 0;
+        for (int x = 0; x < width; ++x)
+        {
+            row[1 + x * 3] = source[x * 4];
+            row[2 + x * 3] = source[x * 4 + 1];
+            row[3 + x * 3] = source[x * 4 + 2];
+        }
+    }
+    std::vector<uint8_t> compressed;
+    if (!deflateScanlines(raw, compressed))
+        return 0;
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    std::vector<uint8_t> out(signature, signature + 8);
+    out.reserve(compressed.size() + 64);
+
+    // IHDR: size, 8 bits per channel, color type 2 (RGB), deflate, adaptive filtering, no interlace
+    std::vector<uint8_t> header;
+    putBigEndian(header, (uint32_t)width);
+    putBigEndian(header, (uint32_t)height);
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });
+    putChunk(out, "IHDR", header.data(), header.size());
+    putChunk(out, "IDAT", compressed.data(), compressed.size());
+    putChunk(out, "IEND", nullptr, 0);
+    return writeFile(path, out.data(), out.size());
+}
+
+void writeY4mHeader(std::ostream& out, int width, int height, int fps)
+{
+    out << "YUV4MPEG2 W" << width << " H" << height << " F" << fps << ":1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n";
+}
+
+size_t y4mFrameBytes(int width, int height)
+{
+    const size_t chroma = (size_t)((width + 1) / 2) * (size_t)((height + 1) / 2);
+    return (size_t)width * (size_t)height + chroma * 2;
+}
+
+void rgbaToYuv420(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& yuv)
+{
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaHeight = (height + 1) / 2;
+    yuv.resize(y4mFrameBytes(width, height));
+    uint8_t* lumaPlane = yuv.data();
+    uint8_t* cbPlane = lumaPlane + (size_t)width * (size_t)height;
+    uint8_t* crPlane = cbPlane + (size_t)chromaWidth * (size_t)chromaHeight;
+
+    // Fixed-point BT.601 coefficients scaled by 256
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t* row = rgba + (size_t)y * (size_t)width * 4;
+        uint8_t* luma = lumaPlane + (size_t)y * (size_t)width;
+        for (int x = 0; x < width; ++x)
+        {
+            const int r = row[x * 4], g = row[x * 4 + 1], b = row[x * 4 + 2];
+            luma[x] = clampByte(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        }
+    }
+    for (int cy = 0; cy < chromaHeight; ++cy)
+    {
+        for (int cx = 0; cx < chromaWidth; ++cx)
+        {
+            // Average the 2x2 block, repeating the last row or column at odd edges
+            int r = 0, g = 0, b = 0;
+            for (int dy = 0; dy < 2; ++dy)
+            {
+                const int y = std::min(cy * 2 + dy, height - 1);
+                for (int dx = 0; dx < 2; ++dx)
+                {
+                    const int x = std::min(cx * 2 + dx, width - 1);
+                    const uint8_t* p = rgba + ((size_t)y * (size_t)width + (size_t)x) * 4;
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                }
+            }
+            r = (r + 2) / 4;
+            g = (g + 2) / 4;
+            b = (b + 2) / 4;
+            const size_t i = (size_t)cy * (size_t)chromaWidth + (size_t)cx;
+            cbPlane[i] = clampByte(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            crPlane[i] = clampByte(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
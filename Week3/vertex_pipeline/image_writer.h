@@ -0,0 +1,28 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Encoders for captured frames. Input is always tightly packed 8-bit RGBA, top row first;
+// alpha is dropped. The image writers return the bytes written, 0 on failure.
+
+// Binary PPM (P6)
+size_t writePpm(const std::string& path, const uint8_t* rgba, int width, int height);
+
+// 8-bit RGB PNG. Compressed with zlib at its fastest level when the build has it
+// (VP_HAVE_ZLIB), otherwise written as stored (uncompressed) deflate blocks.
+size_t writePng(const std::string& path, const uint8_t* rgba, int width, int height);
+
+// YUV4MPEG2 stream: one header, then a FRAME marker and planar 4:2:0 data per frame
+void writeY4mHeader(std::ostream& out, int width, int height, int fps);
+size_t y4mFrameBytes(int width, int height);
+
+// BT.601 limited range Y'CbCr 4:2:0 planes (Y, then Cb, then Cr), chroma averaged over
+// each 2x2 block. yuv is resized to y4mFrameBytes().
+void rgbaToYuv420(const uint8_t* rgba, int width, int height, std::vector<uint8_t>& yuv);
+
+#endif
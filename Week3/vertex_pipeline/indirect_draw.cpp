@@ -0,0 +1,40 @@
+#include "indirect_draw.h"
+
+#include "gl_state.h"
+
+#include <glad/glad.h>
+
+bool IndirectDrawList::supported()
+{
+    // Each command's baseInstance is its first object index, which needs base instance support
+    return GLAD_GL_VERSION_4_3 || (GLAD_GL_ARB_multi_draw_indirect && (GLAD_GL_VERSION_4_2 || GLAD_GL_ARB_base_instance));
+}
+
+void IndirectDrawList::add(const MeshRange& mesh, unsigned int instance)
+{
+    if (!commands.empty())
+    {
+        DrawElementsIndirectCommand& last = commands.back();
+        if (last.firstIndex == mesh.firstIndex && last.baseVertex == mesh.baseVertex &&
+            last.baseInstance + last.instanceCount == instance)
+        {
+            ++last.instanceCount;
+            return;
+        }
+    }
+    commands.push_back(DrawElementsIndirectCommand{ mesh.indexCount, 1, mesh.firstIndex, mesh.baseVertex, instance });
+}
+
+bool IndirectDrawList::submit(StreamBuffer& stream) const
+{
+    if (commands.empty())
+        return true;
+
+    size_t offset = 0;
+    if (!stream.upload(commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand), 4, offset))
+        return false;
+
+    glState().bindBuffer(GL_DRAW_INDIRECT_BUFFER, stream.handle());
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)offset, (GLsizei)commands.size(), 0);
+    return true;
+}
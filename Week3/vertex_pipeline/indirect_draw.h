@@ -0,0 +1,43 @@
+#ifndef INDIRECT_DRAW_H
+#define INDIRECT_DRAW_H
+
+#include "mesh.h"
+#include "stream_buffer.h"
+
+#include <cstddef>
+#include <vector>
+
+// Layout fixed by the GL spec for glMultiDrawElementsIndirect
+struct DrawElementsIndirectCommand
+{
+    unsigned int count;
+    unsigned int instanceCount;
+    unsigned int firstIndex;
+    int baseVertex;
+    unsigned int baseInstance;
+};
+
+// Draw commands built on the CPU each frame and submitted with one glMultiDrawElementsIndirect.
+// baseInstance selects each object's row in the per-instance buffer.
+class IndirectDrawList
+{
+public:
+    // Multi-draw indirect needs GL 4.3, or ARB_multi_draw_indirect plus GL 4.2 or ARB_base_instance
+    static bool supported();
+
+    void clear() { commands.clear(); }
+
+    // Queue one object. Runs of the same mesh with consecutive instances merge into one command.
+    void add(const MeshRange& mesh, unsigned int instance);
+
+    // Upload the commands into the stream buffer and draw them all. The mesh VAO must be bound.
+    // Returns false when the commands do not fit in this frame's stream region.
+    bool submit(StreamBuffer& stream) const;
+
+    int commandCount() const { return (int)commands.size(); }
+
+private:
+    std::vector<DrawElementsIndirectCommand> commands;
+};
+
+#endif
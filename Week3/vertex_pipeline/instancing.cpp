@@ -0,0 +1,41 @@
+#include "instancing.h"
+
+#include "gl_state.h"
+
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+std::vector<glm::mat4> buildInstanceTransforms(const std::vector<glm::vec3>& positions)
+{
+    std::vector<glm::mat4> transforms;
+    transforms.reserve(positions.size());
+    for (const glm::vec3& position : positions)
+        transforms.push_back(glm::translate(glm::mat4(1.0f), position));
+    return transforms;
+}
+
+unsigned int createInstanceBuffer(unsigned int vao, const std::vector<glm::mat4>& transforms)
+{
+    unsigned int buffer;
+    glGenBuffers(1, &buffer);
+    glState().bindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(transforms.size() * sizeof(glm::mat4)), transforms.data(), GL_STATIC_DRAW);
+
+    bindInstanceTransforms(vao, buffer, 0);
+    return buffer;
+}
+
+void bindInstanceTransforms(unsigned int vao, unsigned int buffer, size_t offset)
+{
+    glState().bindVertexArray(vao);
+    glState().bindBuffer(GL_ARRAY_BUFFER, buffer);
+
+    // A mat4 attribute is four vec4 columns, each advancing once per instance
+    for (int column = 0; column < 4; ++column)
+    {
+        GLuint location = (GLuint)(INSTANCE_MATRIX_LOCATION + column);
+        glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(offset + column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+}
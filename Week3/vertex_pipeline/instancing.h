@@ -0,0 +1,22 @@
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// First attribute location of the per-instance mat4 (it occupies four consecutive locations)
+const int INSTANCE_MATRIX_LOCATION = 1;
+
+// Build one translation matrix per instance position
+std::vector<glm::mat4> buildInstanceTransforms(const std::vector<glm::vec3>& positions);
+
+// Upload per-instance model matrices and wire them into the given VAO as an
+// instanced mat4 attribute (divisor 1). Returns the new buffer.
+unsigned int createInstanceBuffer(unsigned int vao, const std::vector<glm::mat4>& transforms);
+
+// Point the VAO's per-instance matrices at tightly packed mat4s starting at offset in buffer
+void bindInstanceTransforms(unsigned int vao, unsigned int buffer, size_t offset);
+
+#endif
@@ -0,0 +1,224 @@
+#include "job_system.h"
+#include "trace.h"
+
+// Index of the queue owned by the current thread, -1 outside the pool
+static thread_local int currentQueue = -1;
+static thread_local const JobSystem* currentSystem = nullptr;
+
+JobSystem::JobSystem(int threads)
+{
+    if (threads <= 0)
+        threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0)
+        threads = 1;
+
+    for (int i = 0; i < threads; ++i)
+        queues.push_back(std::unique_ptr<WorkQueue>(new WorkQueue()));
+    for (int i = 1; i < threads; ++i)
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+}
+
+size_t JobSystem::grainFor(size_t count, size_t minGrain) const
+{
+    const size_t chunks = (size_t)threadCount() * 4;
+    return std::max(minGrain, (count + chunks - 1) / chunks);
+}
+
+void JobSystem::submit(std::function<void()> job, JobCounter* counter)
+{
+    if (counter)
+        counter->remaining.fetch_add(1, std::memory_order_relaxed);
+    push(Job{ std::move(job), counter });
+}
+
+void JobSystem::then(JobCounter& dependency, std::function<void()> job, JobCounter* counter)
+{
+    if (counter)
+        counter->remaining.fetch_add(1, std::memory_order_relaxed);
+    {
+        // The last job of the dependency lowers it and takes the list under this lock,
+        // so a continuation is either queued here or picked up there, never both or neither
+        std::lock_guard<std::mutex> lock(dependency.mutex);
+        if (!dependency.done())
+        {
+            dependency.continuations.push_back(JobCounter::Continuation{ std::move(job), counter });
+            return;
+        }
+    }
+    push(Job{ std::move(job), counter });
+}
+
+void JobSystem::push(Job job)
+{
+    int index = currentSystem == this ? currentQueue : (int)(nextQueue++ % (unsigned int)queues.size());
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->jobs.push_back(std::move(job));
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    // Taking the sleep mutex orders this notify after a worker's check-then-sleep
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_one();
+    // Threads waiting on a counter sleep on idle; wake them to help with the new job
+    if (counterWaiters.load() > 0)
+        idle.notify_all();
+}
+
+bool JobSystem::popLocal(int index, Job& job)
+{
+    WorkQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty())
+        return false;
+    job = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::steal(int thief, Job& job)
+{
+    const int count = (int)queues.size();
+    for (int offset = 1; offset < count; ++offset)
+    {
+        WorkQueue& victim = *queues[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            // Oldest work first: it tends to be the biggest remaining chunk
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::finish(JobCounter* counter)
+{
+    // The counter is lowered under its lock, and wait(counter) takes that lock before it
+    // returns, so the counter is not touched once its owner may destroy it
+    std::vector<JobCounter::Continuation> continuations;
+    bool groupDone = false;
+    if (counter)
+    {
+        std::lock_guard<std::mutex> lock(counter->mutex);
+        groupDone = counter->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        if (groupDone)
+            continuations.swap(counter->continuations);
+    }
+
+    // Queue the continuations before this job stops counting as pending, so wait() cannot
+    // return between the two
+    if (groupDone)
+    {
+        for (JobCounter::Continuation& continuation : continuations)
+            push(Job{ std::move(continuation.job), continuation.counter });
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        idle.notify_all();
+    }
+
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        idle.notify_all();
+    }
+}
+
+bool JobSystem::runOne(int index)
+{
+    Job job;
+    if (!popLocal(index, job) && !steal(index, job))
+        return false;
+
+    job.run();
+    finish(job.counter);
+    return true;
+}
+
+void JobSystem::workerLoop(int index)
+{
+    currentQueue = index;
+    currentSystem = this;
+    TRACE_THREAD_NAME("worker " + std::to_string(index));
+    while (true)
+    {
+        if (runOne(index))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping)
+            return;
+        // Recheck under the lock so a submit between the failed steal and here is not missed
+        wake.wait(lock, [this]() { return stopping || queued.load() > 0; });
+        if (stopping)
+            return;
+    }
+}
+
+void JobSystem::wait()
+{
+    // The waiting thread owns queue 0 while it helps
+    currentQueue = 0;
+    currentSystem = this;
+
+    while (pending.load(std::memory_order_acquire) > 0)
+    {
+        if (runOne(0))
+            continue;
+        // Everything left is running on workers; sleep until it finishes or new work appears
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        idle.wait(lock, [this]() { return pending.load() == 0 || queued.load() > 0; });
+    }
+
+    currentQueue = -1;
+    currentSystem = nullptr;
+}
+
+void JobSystem::wait(JobCounter& counter)
+{
+    // Workers help from their own queue; any other thread owns queue 0 while it helps
+    const bool member = currentSystem == this;
+    const int index = member ? currentQueue : 0;
+    currentQueue = index;
+    currentSystem = this;
+
+    while (!counter.done())
+    {
+        if (runOne(index))
+            continue;
+        ++counterWaiters;
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            idle.wait(lock, [this, &counter]() { return counter.done() || queued.load() > 0; });
+        }
+        --counterWaiters;
+    }
+
+    // The job that finished the group may still hold the counter's lock
+    {
+        std::lock_guard<std::mutex> lock(counter.mutex);
+    }
+
+    if (!member)
+    {
+        currentQueue = -1;
+        currentSystem = nullptr;
+    }
+}
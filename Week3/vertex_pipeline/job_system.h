@@ -0,0 +1,135 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Counts the unfinished jobs of one group. Jobs submitted with a counter raise it and lower
+// it when they finish; continuations registered with JobSystem::then() are queued the moment
+// it reaches zero. A counter can be reused or destroyed once JobSystem::wait() on it returns.
+class JobCounter
+{
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool done() const { return remaining.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    struct Continuation
+    {
+        std::function<void()> job;
+        JobCounter* counter;
+    };
+
+    std::atomic<int> remaining{ 0 };
+    std::mutex mutex;
+    std::vector<Continuation> continuations;
+};
+
+// Work-stealing thread pool. Every worker owns a deque: it pushes and pops its own work
+// at the back and steals from the front of the others when it runs dry. Threads that
+// wait for work to finish help run jobs instead of blocking.
+class JobSystem
+{
+public:
+    // threads <= 0 uses every hardware thread. One of them is the caller of wait().
+    explicit JobSystem(int threads = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Queue a job. From a worker it goes to that worker's deque, otherwise round-robin.
+    // counter, if given, is raised now and lowered when the job finishes.
+    void submit(std::function<void()> job, JobCounter* counter = nullptr);
+
+    // Queue job once dependency reaches zero (right away if it already has). counter is
+    // raised now, so waiting on it also covers the job that has not been queued yet.
+    void then(JobCounter& dependency, std::function<void()> job, JobCounter* counter = nullptr);
+
+    // Run jobs until everything submitted so far has finished. Not for use inside a job.
+    void wait();
+
+    // Run jobs until counter reaches zero. Jobs may wait on counters of their own children.
+    void wait(JobCounter& counter);
+
+    // Call fn(begin, end) over [first, last) in chunks of grain elements (the last one may be
+    // shorter). Chunk k starts at first + k * grain. Without a counter it returns once every
+    // chunk is done; with one it returns at once and the chunks lower the counter.
+    template <typename Fn>
+    void parallelFor(size_t first, size_t last, size_t grain, Fn fn, JobCounter* counter = nullptr);
+
+    // Chunk size for count elements: a few chunks per thread so stealing can balance them,
+    // but never below minGrain so each chunk pays for its job
+    size_t grainFor(size_t count, size_t minGrain) const;
+
+    int threadCount() const { return (int)queues.size(); }
+
+private:
+    struct Job
+    {
+        std::function<void()> run;
+        JobCounter* counter;
+    };
+
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void push(Job job);
+    void finish(JobCounter* counter);
+    void workerLoop(int index);
+    bool runOne(int index);
+    bool popLocal(int index, Job& job);
+    bool steal(int thief, Job& job);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;   // [0] belongs to the waiting thread
+    std::vector<std::thread> workers;
+    std::atomic<int> pending{ 0 };      // submitted and not finished
+    std::atomic<int> queued{ 0 };       // submitted and not started
+    std::atomic<int> counterWaiters{ 0 };
+    std::atomic<unsigned int> nextQueue{ 0 };
+    std::atomic<bool> stopping{ false };
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+};
+
+template <typename Fn>
+void JobSystem::parallelFor(size_t first, size_t last, size_t grain, Fn fn, JobCounter* counter)
+{
+    if (first >= last)
+        return;
+    grain = std::max<size_t>(grain, 1);
+    if (!counter && last - first <= grain)
+    {
+        fn(first, last);
+        return;
+    }
+
+    JobCounter local;
+    JobCounter* group = counter ? counter : &local;
+    for (size_t begin = first; begin < last; begin += grain)
+    {
+        const size_t end = std::min(begin + grain, last);
+        submit([fn, begin, end]() { fn(begin, end); }, group);
+    }
+    if (!counter)
+        wait(local);
+}
+
+#endif
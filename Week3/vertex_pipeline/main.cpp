@@ -1,315 +1,1227 @@
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include "batch.h"
+#include "benchmark.h"
+#include "benchmarks.h"
+#include "culling.h"
+#include "fixed_timestep.h"
+#include "frame_capture.h"
+#include "frame_packet.h"
+#include "gl_call_stats.h"
+#include "gl_state.h"
+#include "gpu_profiler.h"
+#include "hud.h"
+#include "indirect_draw.h"
+#include "instancing.h"
+#include "job_system.h"
+#include "mesh.h"
+#include "options.h"
+#include "platform.h"
+#include "program_cache.h"
+#include "readback_ring.h"
+#include "render_queue.h"
+#include "render_target.h"
+#include "scene.h"
+#include "shader.h"
+#include "shader_reloader.h"
+#if defined(VP_HAVE_SHM_OUTPUT)
+#include "shm_frame_ring.h"
+#endif
+#include "software_rasterizer.h"
+#include "spsc_ring.h"
+#include "stream_buffer.h"
+#include "trace.h"
+#include "uniform_buffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
 #include <vector>
 #include <string>
 
-// Window dimensions
-const unsigned int SCR_WIDTH = 800;
-const unsigned int SCR_HEIGHT = 600;
-
-// Define the different coordinate spaces as integers for coloring
-enum CoordinateSpace {
-    MODEL_SPACE = 0,
-    WORLD_SPACE = 1,
-    VIEW_SPACE = 2,
-    CLIP_SPACE = 3
-};
-
 // Currently active coordinate space for visualization
 int activeSpace = MODEL_SPACE;
 
-// Vertex shader source code
-const char* vertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;
+// Latest framebuffer size from the platform; the simulation picks it up at the start of a frame
+int framebufferWidth = 0;
+int framebufferHeight = 0;
+bool framebufferResized = false;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
-uniform int activeSpace;
+// The scene shaders are read from shaders/scene.vert and scene.frag (see --shader-dir).
+// Each coordinate space is compiled as its own variant with these defines, so there is
+// no per-vertex branching on the active space.
+const std::vector<std::vector<std::string>> spaceDefines = {
+    { "SPACE_MODEL", "SPACE_COLOR vec3(1.0, 0.0, 0.0)" },   // Red for model space
+    { "SPACE_WORLD", "SPACE_COLOR vec3(0.0, 1.0, 0.0)" },   // Green for world space
+    { "SPACE_VIEW", "SPACE_COLOR vec3(0.0, 0.0, 1.0)" },    // Blue for view space
+    { "SPACE_CLIP", "SPACE_COLOR vec3(1.0, 1.0, 0.0)" }     // Yellow for clip space
+};
 
-out vec3 vertexColor;
+// Function prototypes
+void framebuffer_size_callback(int width, int height);
+void processInput(Platform& platform);
+void key_callback(int key);
 
-void main()
+int main(int argc, char** argv)
 {
-    // Calculate positions in different coordinate spaces
-    vec4 modelPos = vec4(aPos, 1.0);
-    vec4 worldPos = model * modelPos;
-    vec4 viewPos = view * worldPos;
-    vec4 clipPos = projection * viewPos;
-    
-    // Output the position based on the active space
-    if (activeSpace == 0) {
-        gl_Position = projection * view * vec4(aPos, 1.0); // Still transform fully for display
-        vertexColor = vec3(1.0, 0.0, 0.0); // Red for model space
-    } 
-    else if (activeSpace == 1) {
-        gl_Position = projection * view * model * vec4(aPos, 1.0);
-        vertexColor = vec3(0.0, 1.0, 0.0); // Green for world space
-    }
-    else if (activeSpace == 2) {
-        gl_Position = projection * view * model * vec4(aPos, 1.0);
-        vertexColor = vec3(0.0, 0.0, 1.0); // Blue for view space
-    }
-    else if (activeSpace == 3) {
-        gl_Position = projection * view * model * vec4(aPos, 1.0);
-        vertexColor = vec3(1.0, 1.0, 0.0); // Yellow for clip space
+    Options options;
+    if (!parseOptions(argc, argv, options))
+        return -1;
+
+    // Offline benchmarks run on the CPU only and never open a window
+    if (options.bench == "transform")
+        return runTransformBenchmark(options);
+    if (options.bench == "raster")
+        return runRasterBenchmark(options);
+    if (options.bench == "cull")
+        return runCullBenchmark(options);
+    if (options.bench == "queue")
+        return runQueueBenchmark(options);
+    if (options.bench == "jobs")
+        return runJobsBenchmark(options);
+#if defined(VP_HAVE_SHM_OUTPUT)
+    if (options.bench == "shm")
+        return runShmBenchmark(options);
+#endif
+    if (!options.bench.empty())
+    {
+        std::cout << "ERROR::OPTIONS::UNKNOWN_BENCHMARK " << options.bench << std::endl;
+        return -1;
     }
-}
-)";
 
-// Fragment shader source code
-const char* fragmentShaderSource = R"(
-#version 330 core
-in vec3 vertexColor;
-out vec4 FragColor;
+#if !defined(VP_TRACING)
+    if (!options.tracePath.empty())
+    {
+        std::cout << "ERROR::TRACE::NOT_COMPILED_IN rebuild with VP_TRACING=ON to use --trace" << std::endl;
+        return -1;
+    }
+#endif
 
-void main()
-{
-    FragColor = vec4(vertexColor, 1.0);
-}
-)";
+    // --batch-processes forks its workers before any thread or context exists
+    if (options.batchProcesses > 1)
+    {
+#if defined(VP_HAVE_BATCH_PROCESSES)
+        int result = 0;
+        if (runBatchFarm(options, result))
+            return result;
+#else
+        std::cout << "ERROR::BATCH::NOT_AVAILABLE --batch-processes needs fork(); use --shard to split the jobs by hand" << std::endl;
+        return -1;
+#endif
+    }
 
-// Function prototypes
-void framebuffer_size_callback(GLFWwindow* window, int width, int height);
-void processInput(GLFWwindow* window);
-void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    if (!options.tracePath.empty())
+    {
+        TRACE_THREAD_NAME("main");
+        traceStart();
+    }
 
-int main()
-{
-    // Initialize GLFW
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-    // Create a GLFW window
-    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Vertex Transformation Pipeline", NULL, NULL);
-    if (window == NULL)
-    {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
+    // The software renderer needs no window system or GL at all
+    if (options.software)
+    {
+        int result = runSoftwareHeadless(options);
+        if (!options.tracePath.empty())
+        {
+            traceStop();
+            traceWriteJson(options.tracePath);
+        }
+        return result;
+    }
+
+    // Create the window and context. Headless runs still need a context, so they use a
+    // hidden window, or no window system at all with --platform egl/osmesa, and render into an FBO.
+    std::unique_ptr<Platform> platform = createPlatform(options.platform);
+    if (!platform)
+        return -1;
+    if (!platform->init(options.width, options.height, !options.headless, "Vertex Transformation Pipeline"))
+    {
+        std::cout << "Failed to create a " << platformName(options.platform) << " context" << std::endl;
         return -1;
     }
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetKeyCallback(window, key_callback);
+    platform->setResizeCallback(framebuffer_size_callback);
+    platform->setKeyCallback(key_callback);
 
     // Load OpenGL function pointers with GLAD
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    if (!platform->loadGL())
     {
         std::cout << "Failed to initialize GLAD" << std::endl;
+        platform->destroy();
         return -1;
     }
+    glCallStatsInstall();
 
-    // Build and compile the shader program
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-    glCompileShader(vertexShader);
-    // Check for shader compile errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
-    glCompileShader(fragmentShader);
-    // Check for shader compile errors
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    
-    // Link shaders
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
-    // Check for linking errors
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-    }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
-
-    // Set up vertex data for a cube
-    float vertices[] = {
-        // Front face
-        -0.5f, -0.5f,  0.5f,
-         0.5f, -0.5f,  0.5f,
-         0.5f,  0.5f,  0.5f,
-        -0.5f,  0.5f,  0.5f,
-        
-        // Back face
-        -0.5f, -0.5f, -0.5f,
-         0.5f, -0.5f, -0.5f,
-         0.5f,  0.5f, -0.5f,
-        -0.5f,  0.5f, -0.5f
-    };
-    
-    unsigned int indices[] = {
-        // Front face
-        0, 1, 2,
-        2, 3, 0,
-        
-        // Right face
-        1, 5, 6,
-        6, 2, 1,
-        
-        // Back face
-        5, 4, 7,
-        7, 6, 5,
-        
-        // Left face
-        4, 0, 3,
-        3, 7, 4,
-        
-        // Top face
-        3, 2, 6,
-        6, 7, 3,
-        
-        // Bottom face
-        4, 5, 1,
-        1, 0, 4
-    };
+    // Scene shader sources come from files so they can be edited without a rebuild
+    const std::string vertexShaderPath = options.shaderDir + "/scene.vert";
+    const std::string fragmentShaderPath = options.shaderDir + "/scene.frag";
+    std::string vertexShaderSource, fragmentShaderSource;
+    if (!loadShaderFile(vertexShaderPath, vertexShaderSource) || !loadShaderFile(fragmentShaderPath, fragmentShaderSource))
+    {
+        platform->destroy();
+        return -1;
+    }
 
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
-    
-    glBindVertexArray(VAO);
+    // Build and compile one shader program per coordinate space up front.
+    // Uniforms are reflected once per variant; the render loop only uses cached locations.
+    // Linked binaries are cached on disk, so only the first launch pays for compilation.
+    auto shaderStart = std::chrono::steady_clock::now();
+    ProgramCache programCache;
+    bool useCache = !options.shaderCache.empty() && programCache.init(options.shaderCache);
+    // Instanced and multi-draw scenes use the same variants with per-instance matrices enabled
+    const bool perInstance = options.instanced || options.multiDraw;
+    if (options.multiDraw && !IndirectDrawList::supported())
+    {
+        std::cout << "ERROR::MULTI_DRAW::UNSUPPORTED (needs OpenGL 4.3, or ARB_multi_draw_indirect with OpenGL 4.2 or ARB_base_instance)" << std::endl;
+        platform->destroy();
+        return -1;
+    }
+    std::vector<std::vector<std::string>> variantDefines = spaceDefines;
+    if (perInstance)
+    {
+        for (std::vector<std::string>& defines : variantDefines)
+            defines.push_back("INSTANCED");
+    }
+    ShaderVariants spacePrograms;
+    if (!spacePrograms.build(vertexShaderSource.c_str(), fragmentShaderSource.c_str(), variantDefines, useCache ? &programCache : nullptr))
+    {
+        platform->destroy();
+        return -1;
+    }
 
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    StartupStats startup;
+    startup.shaderMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - shaderStart).count();
+    startup.cacheEnabled = useCache;
+    startup.cacheHits = programCache.stats().hits;
+    startup.cacheMisses = programCache.stats().misses;
+    startup.cacheStale = programCache.stats().stale;
+    startup.warmLoadMs = programCache.stats().loadMs;
+    startup.coldCompileMs = useCache ? programCache.stats().compileMs : startup.shaderMs;
+    if (!options.headless)
+    {
+        std::cout << "Shader programs ready in " << startup.shaderMs << " ms ("
+                  << startup.cacheHits << " loaded from cache in " << startup.warmLoadMs << " ms, "
+                  << startup.cacheMisses << " compiled in " << startup.coldCompileMs << " ms)" << std::endl;
+    }
+    spacePrograms.bindUniformBlock("FrameData", FRAME_DATA_BINDING);
+    std::vector<int> modelLocs;
+    for (int i = 0; i < spacePrograms.count(); ++i)
+        modelLocs.push_back(spacePrograms[i].reflection.location("model"));
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    // --watch-shaders rebuilds the variants on a background context as the files are edited
+    ShaderReloader shaderReloader;
+    if (options.watchShaders && !shaderReloader.init(*platform, vertexShaderPath, fragmentShaderPath, variantDefines))
+    {
+        platform->destroy();
+        return -1;
+    }
 
-    // Position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    // Pack every mesh into shared vertex/index buffers. The cube is always the first mesh;
+    // multi-draw scenes add more shapes so objects are not all the same mesh.
+    MeshRegistry meshes;
+    const int cubeMesh = meshes.add(makeCube());
+    if (options.multiDraw)
+    {
+        meshes.add(makePyramid());
+        meshes.add(makeOctahedron());
+    }
+    meshes.upload();
+    const GLsizei cubeIndexCount = (GLsizei)meshes.range(cubeMesh).indexCount;
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // Lay the cubes out on a grid
+    SceneLayout scene = buildScene(options.objects);
+    const std::vector<glm::vec3>& cubePositions = scene.positions;
 
-    // Enable depth testing
-    glEnable(GL_DEPTH_TEST);
+    // --batch renders each job of its shard once, as one frame
+    BatchRun batch;
+    if (!options.batchPath.empty())
+    {
+        if (!batch.init(options, scene))
+        {
+            platform->destroy();
+            return -1;
+        }
+        if (batch.size() == 0)
+        {
+            std::cout << "Shard " << options.shardIndex << "/" << options.shardCount << " has no jobs" << std::endl;
+            platform->destroy();
+            return 0;
+        }
+        options.frames = (int)batch.size();
+    }
 
-    // Render loop
-    while (!glfwWindowShouldClose(window))
+    // Instanced and multi-draw modes keep every object's placement in a per-instance buffer
+    unsigned int instanceBuffer = 0;
+    std::vector<glm::mat4> instanceTransforms;
+    if (perInstance)
     {
+        instanceTransforms = buildInstanceTransforms(cubePositions);
+        instanceBuffer = createInstanceBuffer(meshes.VAO, instanceTransforms);
+    }
+
+    // Multi-draw objects cycle through the registered meshes; commands are rebuilt every frame
+    std::vector<int> objectMeshes;
+    if (options.multiDraw)
+    {
+        objectMeshes.resize(cubePositions.size());
+        for (size_t i = 0; i < objectMeshes.size(); ++i)
+            objectMeshes[i] = (int)(i % (size_t)meshes.count());
+    }
+
+    // Per-object CPU work (culling, model matrices, gathering instances) is spread over
+    // a work-stealing pool; the main thread helps whenever it waits for a result
+    JobSystem frameJobs(options.threads);
+
+    // Bounding spheres for frustum culling. Objects only spin about their own center,
+    // so a sphere around the mesh origin at the object's position holds for every frame.
+    BoundingSpheres bounds;
+    const TransformKernel cullKernel = bestKernel();
+    if (options.cull)
+    {
+        std::vector<float> meshRadius;
+        for (int i = 0; i < meshes.count(); ++i)
+        {
+            const MeshRange& range = meshes.range(i);
+            meshRadius.push_back(boundingRadius(meshes.positions().data() + (size_t)range.baseVertex * 3, range.vertexCount));
+        }
+        bounds.resize(cubePositions.size());
+        for (size_t i = 0; i < cubePositions.size(); ++i)
+            bounds.set(i, cubePositions[i], meshRadius[objectMeshes.empty() ? 0 : objectMeshes[i]]);
+    }
+    double cullMsTotal = 0.0;
+    double visibleTotal = 0.0;
+
+    // Per-object draws go through a sorted queue: grouped by state, nearest first for early-Z.
+    // Their model matrices are computed on the pool while the simulating thread sorts.
+    JobCounter modelsReady;
+    const float farPlane = sceneFarPlane(scene);
+
+    // All per-frame data (uniforms, culled instance matrices, indirect commands, overlay quads)
+    // is streamed through one persistently mapped buffer with a region per frame in flight.
+    // Each region is sized for the worst case frame of this scene.
+    size_t streamBytesPerFrame = 64 * 1024 + Hud::streamBytes();
+    if (options.instanced)
+        streamBytesPerFrame += cubePositions.size() * sizeof(glm::mat4);
+    if (options.multiDraw)
+        streamBytesPerFrame += cubePositions.size() * sizeof(DrawElementsIndirectCommand);
+    StreamBuffer stream;
+    if (!stream.init(streamBytesPerFrame))
+    {
+        platform->destroy();
+        return -1;
+    }
+
+    // Every per-frame state change goes through the cache, which drops the redundant ones
+    GlState& state = glState();
+    state.setDepthTest(true);
+
+    // The scene is drawn into a pooled offscreen target: at the requested size when headless,
+    // otherwise at the framebuffer size and then copied to the window
+    RenderTargetPool targetPool;
+    int targetWidth = (int)options.width;
+    int targetHeight = (int)options.height;
+    if (!options.headless)
+        platform->framebufferSize(targetWidth, targetHeight);
+    RenderTarget* sceneTarget = targetPool.acquire(targetWidth, targetHeight);
+    if (!sceneTarget)
+    {
+        platform->destroy();
+        return -1;
+    }
+
+    // Many drivers finish compiling on the first draw, so draw once with every
+    // variant now rather than hitching the first time a key selects it
+    FrameData warmupData = {};
+    // Into the scene target: surfaceless contexts have no default framebuffer to draw to
+    state.bindFramebuffer(GL_FRAMEBUFFER, sceneTarget->fbo);
+    stream.beginFrame();
+    uploadUniformBlock(stream, FRAME_DATA_BINDING, &warmupData, sizeof(FrameData));
+    state.bindVertexArray(meshes.VAO);
+    for (int i = 0; i < spacePrograms.count(); ++i)
+    {
+        state.useProgram(spacePrograms[i].program);
+        glDrawElements(GL_TRIANGLES, cubeIndexCount, GL_UNSIGNED_INT, 0);
+    }
+    stream.endFrame();
+
+    // --capture reads every frame back without stalling and encodes it on worker threads
+    FrameCapture capture;
+    if (!options.capturePath.empty() &&
+        !capture.init(options.capturePath, sceneTarget->width, sceneTarget->height, options.captureThreads, 60))
+    {
+        platform->destroy();
+        return -1;
+    }
+    if (batch.active())
+    {
+        // Batch images are numbered by job, which a single video stream cannot do
+        if (capture.format() == CAPTURE_Y4M)
+        {
+            std::cout << "ERROR::BATCH::NEEDS_IMAGE_CAPTURE use --capture FILE.png or FILE.ppm" << std::endl;
+            platform->destroy();
+            return -1;
+        }
+        capture.setWrittenHandler([&batch](int job, bool written) { batch.written(job, written); });
+    }
+
+    // --shm-output publishes every frame into a shared-memory ring that other processes map.
+    // Frames come back through their own readback ring and are copied into the next slot.
+    ReadbackRing shmReadback;
+#if defined(VP_HAVE_SHM_OUTPUT)
+    ShmFrameWriter shmWriter;
+    if (!options.shmPath.empty() &&
+        (!shmWriter.init(options.shmPath, sceneTarget->width, sceneTarget->height) ||
+         !shmReadback.init(sceneTarget->width, sceneTarget->height)))
+    {
+        platform->destroy();
+        return -1;
+    }
+    // steady_clock is CLOCK_MONOTONIC on Linux, the clock consumers compare against
+    const ReadbackHandler publishFrame = [&shmWriter](const Readback& finished) {
+        shmWriter.publish(finished.frame, finished.pixels, true,
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(finished.issued.time_since_epoch()).count());
+    };
+#else
+    if (!options.shmPath.empty())
+    {
+        std::cout << "ERROR::SHM::NOT_AVAILABLE shared-memory output is only built on Linux" << std::endl;
+        platform->destroy();
+        return -1;
+    }
+    const ReadbackHandler publishFrame = [](const Readback&) {};
+#endif
+
+    // The camera is fixed; projection and the culling frustum only change with the target size.
+    // The simulation side owns them and hands each frame's camera to the render side.
+    const glm::mat4 view = sceneView(scene);
+    int simWidth = sceneTarget->width;
+    int simHeight = sceneTarget->height;
+    glm::mat4 projection = sceneProjection(scene, simWidth, simHeight);
+    Frustum frustum = extractFrustum(projection * view);
+
+    // Motion advances in fixed steps, whatever the frame rate; frames show the state
+    // interpolated to their own point in time
+    FixedTimestep simulation((double)options.simRate);
+    double lastClock = 0.0;
+
+    // Frame timing
+    const bool benchmarking = options.frames > 0;
+    BenchmarkRecorder recorder;
+    if (benchmarking)
+    {
+        recorder.reserve(options.frames);
+        recorder.setStartup(startup);
+    }
+    auto recordGpuTime = [&recorder](int frame, double gpuMs) { recorder.setGpuTime(frame, gpuMs); };
+
+    // Per-pass GPU timings; the rolling averages are shown in the overlay
+    GpuProfiler gpuProfiler;
+    gpuProfiler.init();
+
+    // Windowed runs draw a stats overlay; headless output stays just the scene
+    Hud hud;
+    if (!options.headless && !hud.init())
+    {
+        platform->destroy();
+        return -1;
+    }
+    const int FRAME_HISTORY = 120;
+    float frameHistory[FRAME_HISTORY] = {};
+    int titleSpace = -1;
+
+    // Simulation: input, clock, camera, culling and the CPU side of the draws, written into a
+    // packet. It never touches GL, so it can run on a thread that does not own the context.
+    auto simulateFrame = [&](int frame, FramePacket& packet)
+    {
+        TRACE_SCOPE("simulate");
+        packet.simulateStart = std::chrono::steady_clock::now();
+        packet.frame = frame;
+        packet.quit = false;
+
         // Input
-        processInput(window);
+        processInput(*platform);
+
+        // Follow window resizes; the render side brings its target to the packet's size
+        if (framebufferResized)
+        {
+            framebufferResized = false;
+            if (framebufferWidth > 0 && framebufferHeight > 0 &&
+                (framebufferWidth != simWidth || framebufferHeight != simHeight))
+            {
+                simWidth = framebufferWidth;
+                simHeight = framebufferHeight;
+                projection = sceneProjection(scene, simWidth, simHeight);
+                frustum = extractFrustum(projection * view);
+            }
+        }
+
+        // The title only carries the coordinate space, so only touch it when that changes
+        if (!options.headless && activeSpace != titleSpace)
+        {
+            TRACE_SCOPE("title");
+            char title[128];
+            std::snprintf(title, sizeof(title), "Vertex Transformation Pipeline - %s (Press 1-4 to change)", spaceName(activeSpace));
+            platform->setTitle(title);
+            titleSpace = activeSpace;
+        }
+
+        packet.space = activeSpace;
+        packet.width = simWidth;
+        packet.height = simHeight;
+        packet.view = view;
+        packet.projection = projection;
+
+        // Feed the real time since the last frame to the fixed-step update. Headless runs
+        // advance a fixed 60 Hz clock so every run renders the same frames.
+        const double clock = options.headless ? (double)frame / 60.0 : platform->time();
+        if (frame > 0)
+        {
+            TRACE_SCOPE("update");
+            simulation.advance(clock - lastClock);
+        }
+        lastClock = clock;
+        const SimState sim = simulation.interpolated();
+        packet.time = (float)sim.time;
+        packet.spin = (float)sim.spin;
+
+        // A batch job replaces all of that with its own camera, rotation and coordinate space
+        packet.job = -1;
+        Frustum jobFrustum;
+        const Frustum* cullFrustum = &frustum;
+        float depthNear = SCENE_NEAR_PLANE;
+        float depthFar = farPlane;
+        if (batch.active())
+        {
+            const BatchJob& job = batch[frame];
+            batch.started(frame, packet.simulateStart);
+            packet.job = job.index;
+            packet.space = job.space;
+            packet.view = batchView(job);
+            packet.projection = batchProjection(job, simWidth, simHeight);
+            packet.time = job.time;
+            packet.spin = job.spin;
+            jobFrustum = extractFrustum(packet.projection * packet.view);
+            cullFrustum = &jobFrustum;
+            depthNear = job.nearPlane;
+            depthFar = job.farPlane;
+        }
+        const float spin = packet.spin;
+
+        // Keep only objects inside the frustum. Per-draw model space puts every cube at the
+        // origin, so there is nothing to cull there.
+        const bool culled = options.cull && (perInstance || packet.space != MODEL_SPACE);
+        packet.culled = culled;
+        packet.visibleCount = cubePositions.size();
+        if (culled)
+        {
+            TRACE_SCOPE("cull");
+            auto cullStart = std::chrono::steady_clock::now();
+            packet.visibleCount = cullSpheres(frameJobs, cullKernel, *cullFrustum, bounds, packet.visibleObjects);
+            cullMsTotal += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullStart).count();
+        }
+        const size_t visibleCount = packet.visibleCount;
+        visibleTotal += (double)visibleCount;
+
+        if (options.multiDraw)
+        {
+            // Every object in one indirect submission, whatever its mesh
+            packet.drawList.clear();
+            for (size_t k = 0; k < visibleCount; ++k)
+            {
+                size_t i = culled ? packet.visibleObjects[k] : k;
+                packet.drawList.add(meshes.range(objectMeshes[i]), (unsigned int)i);
+            }
+        }
+        else if (options.instanced)
+        {
+            // Gather the placements of the survivors for the render side to stream
+            if (culled)
+            {
+                packet.instanceTransforms.resize(visibleCount);
+                frameJobs.parallelFor(0, visibleCount, frameJobs.grainFor(visibleCount, 8192), [&](size_t first, size_t last) {
+                    for (size_t k = first; k < last; ++k)
+                        packet.instanceTransforms[k] = instanceTransforms[packet.visibleObjects[k]];
+                });
+            }
+        }
+        else
+        {
+            // Model matrices go to the pool while this thread queues the cubes with their
+            // distance from the camera and sorts them. The payload is the visible index.
+            packet.drawModels.resize(visibleCount);
+            frameJobs.parallelFor(0, visibleCount, frameJobs.grainFor(visibleCount, 1024), [&](size_t first, size_t last) {
+                TRACE_SCOPE("models");
+                for (size_t k = first; k < last; ++k)
+                    packet.drawModels[k] = objectModel(cubePositions[culled ? packet.visibleObjects[k] : k], spin);
+            }, &modelsReady);
+            {
+                TRACE_SCOPE("queue");
+                packet.drawQueue.clear();
+                packet.drawQueue.reserve(cubePositions.size());
+                for (size_t k = 0; k < visibleCount; ++k)
+                {
+                    const uint32_t object = culled ? packet.visibleObjects[k] : (uint32_t)k;
+                    const float distance = -(packet.view * glm::vec4(cubePositions[object], 1.0f)).z;
+                    const uint32_t depth = quantizeDepth(distance, depthNear, depthFar);
+                    packet.drawQueue.push(makeSortKey(PASS_OPAQUE, (uint32_t)packet.space, 0, (uint32_t)cubeMesh, depth), (uint32_t)k);
+                }
+                packet.drawQueue.sort();
+            }
+            {
+                TRACE_SCOPE("models wait");
+                frameJobs.wait(modelsReady);
+            }
+        }
+
+        packet.simulateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - packet.simulateStart).count();
+    };
+
+    // Pipeline measurements: how long each side takes, and how old a frame is by the time
+    // it has been submitted (presented, when windowed)
+    std::vector<double> simulateSamples, renderSamples, latencySamples;
+    if (benchmarking)
+    {
+        simulateSamples.reserve(options.frames);
+        renderSamples.reserve(options.frames);
+        latencySamples.reserve(options.frames);
+    }
+    double lastLatencyMs = 0.0;
+    int frame = 0;                          // frames rendered
+    int lastSpace = activeSpace;            // space and spin of the last rendered frame
+    float lastSpin = 0.0f;
+    auto lastFrameEnd = std::chrono::steady_clock::now();
+
+    // Render: everything that talks to GL, driven only by the packet
+    auto renderFrame = [&](const FramePacket& packet)
+    {
+        TRACE_SCOPE("render");
+        auto renderStart = std::chrono::steady_clock::now();
+        glCallStatsBeginFrame();
+        {
+            TRACE_SCOPE("gpu queries");
+            gpuProfiler.collect(false, recordGpuTime);
+            gpuProfiler.beginFrame(frame);
+        }
+        state.beginFrame();
+
+        // Rebuilt shaders go live between frames. The old program names are gone, so the
+        // cached locations and the state shadow's current program have to be refreshed.
+        if (shaderReloader.active() && shaderReloader.update(spacePrograms))
+        {
+            for (int i = 0; i < spacePrograms.count(); ++i)
+                modelLocs[i] = spacePrograms[i].reflection.location("model");
+            state.invalidate();
+        }
+
+        // Claim this frame's stream region; only waits if the GPU is FRAMES frames behind
+        {
+            TRACE_SCOPE("stream wait");
+            stream.beginFrame();
+        }
+
+        // Follow the simulation's target size. The old target goes back to the pool first,
+        // so a size in the same storage step gets the very same target back.
+        targetPool.endFrame();
+        if (packet.width != sceneTarget->width || packet.height != sceneTarget->height)
+        {
+            TRACE_SCOPE("resize");
+            const int oldWidth = sceneTarget->width;
+            const int oldHeight = sceneTarget->height;
+            targetPool.release(sceneTarget);
+            sceneTarget = targetPool.acquire(packet.width, packet.height);
+            if (!sceneTarget)
+                sceneTarget = targetPool.acquire(oldWidth, oldHeight);
+        }
+        state.bindFramebuffer(GL_FRAMEBUFFER, sceneTarget->fbo);
+        state.viewport(0, 0, sceneTarget->width, sceneTarget->height);
+        state.setDepthTest(true);
+        state.setBlend(false);
 
         // Render
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        gpuProfiler.beginScope("clear");
+        state.clearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        gpuProfiler.endScope();
+
+        // Activate the variant for the packet's coordinate space
+        const ShaderVariant& variant = spacePrograms[packet.space];
+        const int modelLoc = modelLocs[packet.space];
+        state.useProgram(variant.program);
+
+        // Upload the per-frame block in one copy
+        {
+            TRACE_SCOPE("uniforms");
+            FrameData frameData = {};
+            frameData.view = packet.view;
+            frameData.projection = packet.projection;
+            frameData.time = packet.time;
+            uploadUniformBlock(stream, FRAME_DATA_BINDING, &frameData, sizeof(FrameData));
+        }
+
+        size_t visibleCount = packet.visibleCount;
+        int drawCalls = 0;
+        {
+            TRACE_SCOPE("draw");
+            gpuProfiler.beginScope("draw");
+            state.bindVertexArray(meshes.VAO);
+            if (perInstance)
+            {
+                // The rotation shared by every object goes in the model uniform
+                glm::mat4 model = objectRotation(packet.spin);
+                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+            }
+
+            if (options.multiDraw)
+            {
+                // The overflow is also counted in the stream stats; this frame draws nothing
+                if (packet.drawList.submit(stream))
+                    drawCalls = visibleCount > 0 ? 1 : 0;
+                else
+                    std::cout << "ERROR::MULTI_DRAW::STREAM_FULL " << packet.drawList.commandCount() << " commands skipped" << std::endl;
+            }
+            else if (options.instanced)
+            {
+                // Stream the visible placements and point the instance attributes at them,
+                // then draw every cube in one call. If the region is somehow full, fall back
+                // to the static buffer holding every placement.
+                if (packet.culled)
+                {
+                    size_t offset = 0;
+                    if (stream.upload(packet.instanceTransforms.data(), visibleCount * sizeof(glm::mat4), sizeof(glm::vec4), offset))
+                    {
+                        bindInstanceTransforms(meshes.VAO, stream.handle(), offset);
+                    }
+                    else
+                    {
+                        bindInstanceTransforms(meshes.VAO, instanceBuffer, 0);
+                        visibleCount = cubePositions.size();
+                    }
+                }
+                if (visibleCount > 0)
+                    glDrawElementsInstanced(GL_TRIANGLES, cubeIndexCount, GL_UNSIGNED_INT, 0, (GLsizei)visibleCount);
+                drawCalls = visibleCount > 0 ? 1 : 0;
+            }
+            else
+            {
+                // One call per cube, switching program only where the key's state bits change
+                uint64_t stateKey = 0;
+                int drawModelLoc = modelLoc;
+                for (size_t k = 0; k < packet.drawQueue.size(); ++k)
+                {
+                    const DrawItem& item = packet.drawQueue[k];
+                    if (k == 0 || ((item.key ^ stateKey) & SORT_KEY_STATE_MASK) != 0)
+                    {
+                        const uint32_t program = sortKeyProgram(item.key);
+                        state.useProgram(spacePrograms[(int)program].program);
+                        drawModelLoc = modelLocs[program];
+                        stateKey = item.key;
+                    }
+                    glUniformMatrix4fv(drawModelLoc, 1, GL_FALSE, glm::value_ptr(packet.drawModels[item.payload]));
+                    glDrawElements(GL_TRIANGLES, cubeIndexCount, GL_UNSIGNED_INT, 0);
+                }
+                drawCalls = (int)packet.drawQueue.size();
+            }
+
+            gpuProfiler.endScope();
+        }
+
+        // Only the scene is captured, before the overlay is drawn
+        if (capture.active())
+        {
+            TRACE_SCOPE("capture");
+            gpuProfiler.beginScope("capture");
+            capture.readFrame(sceneTarget->fbo, sceneTarget->width, sceneTarget->height, packet.job);
+            gpuProfiler.endScope();
+        }
+        if (shmReadback.active() && sceneTarget->width == shmReadback.readWidth() && sceneTarget->height == shmReadback.readHeight())
+        {
+            TRACE_SCOPE("shm output");
+            gpuProfiler.beginScope("shm");
+            shmReadback.read(sceneTarget->fbo, packet.frame, publishFrame);
+            gpuProfiler.endScope();
+        }
+
+        if (options.headless)
+        {
+            stream.endFrame();
+            gpuProfiler.endFrame();
+
+            // Nothing is presented, so flush to keep the GPU busy and the frame times honest
+            TRACE_SCOPE("flush");
+            glFlush();
+        }
+        else
+        {
+            // Copy the scene to the window; the overlay is drawn straight on top
+            {
+                TRACE_SCOPE("blit");
+                gpuProfiler.beginScope("blit");
+                state.bindFramebuffer(GL_READ_FRAMEBUFFER, sceneTarget->fbo);
+                state.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+                glBlitFramebuffer(0, 0, sceneTarget->width, sceneTarget->height,
+                                  0, 0, sceneTarget->width, sceneTarget->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+                gpuProfiler.endScope();
+            }
+
+            // Overlay: coordinate space, frame rate, counters, GPU passes and a frame time graph
+            {
+                TRACE_SCOPE("hud");
+                gpuProfiler.beginScope("hud");
+                hud.begin(sceneTarget->width, sceneTarget->height);
+
+                float meanMs = 0.0f;
+                for (float ms : frameHistory)
+                    meanMs += ms;
+                meanMs /= (float)FRAME_HISTORY;
+
+                const glm::vec4 white(1.0f, 1.0f, 1.0f, 1.0f);
+                const float lineHeight = 18.0f;
+                float y = 10.0f;
+                char line[128];
+                const float hudLines = 8.0f + (glCallStatsEnabled() ? 2.0f : 0.0f) + (float)gpuProfiler.scopeCount();
+                hud.rect(6.0f, 6.0f, 330.0f, lineHeight * hudLines + 60.0f, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+                std::snprintf(line, sizeof(line), "%s (1-4)", spaceName(packet.space));
+                hud.text(10.0f, y, line, glm::vec4(spaceColor(packet.space), 1.0f));
+                y += lineHeight;
+                std::snprintf(line, sizeof(line), "FPS %.1f  CPU %.2f MS", meanMs > 0.0f ? 1000.0f / meanMs : 0.0f, meanMs);
+                hud.text(10.0f, y, line, white);
+                y += lineHeight;
+                std::snprintf(line, sizeof(line), "SIM %.2f MS  LATENCY %.1f MS%s", packet.simulateMs, lastLatencyMs,
+                              options.renderThread ? "  (THREADED)" : "");
+                hud.text(10.0f, y, line, white);
+                y += lineHeight;
+                std::snprintf(line, sizeof(line), "OBJECTS %zu  VISIBLE %zu", cubePositions.size(), visibleCount);
+                hud.text(10.0f, y, line, white);
+                y += lineHeight;
+                std::snprintf(line, sizeof(line), "DRAW CALLS %d", drawCalls);
+                hud.text(10.0f, y, line, white);
+                y += lineHeight;
+                std::snprintf(line, sizeof(line), "TARGET %dX%d  ALLOCS %d", sceneTarget->width, sceneTarget->height, targetPool.allocations());
+                hud.text(10.0f, y, line, white);
+                y += lineHeight;
+                const StreamStats& streamStats = stream.stats();
+                std::snprintf(line, sizeof(line), "STREAM WAITS %llu (%.1f MS)  PEAK %zu KB",
+                              (unsigned long long)streamStats.fenceWaits, streamStats.waitMs, streamStats.peakBytes / 1024);
+                hud.text(10.0f, y, line, white);
+                y += lineHeight;
+                const GlStateStats& stateStats = state.lastFrame();
+                std::snprintf(line, sizeof(line), "GL STATE CALLS %llu  ELIDED %llu",
+                              (unsigned long long)stateStats.issued, (unsigned long long)stateStats.elided);
+                hud.text(10.0f, y, line, white);
+                y += lineHeight;
+                if (glCallStatsEnabled())
+                {
+                    GlCallCounts calls = glCallStatsLastFrame();
+                    std::snprintf(line, sizeof(line), "GL CALLS %llu  DRIVER %.2f MS", (unsigned long long)calls.calls, calls.ms());
+                    hud.text(10.0f, y, line, white);
+                    y += lineHeight;
+                    GlCallCounts top;
+                    const char* topName = glCallStatsLastFrameTop(top);
+                    std::snprintf(line, sizeof(line), "TOP %s X%llu %.2f MS", topName, (unsigned long long)top.calls, top.ms());
+                    hud.text(10.0f, y, line, white);
+                    y += lineHeight;
+                }
+                for (int i = 0; i < gpuProfiler.scopeCount(); ++i)
+                {
+                    std::snprintf(line, sizeof(line), "GPU %-6s %.3f MS", gpuProfiler.scopeName(i).c_str(), gpuProfiler.averageMs(i));
+                    hud.text(10.0f, y, line, white);
+                    y += lineHeight;
+                }
 
-        // Activate shader
-        glUseProgram(shaderProgram);
-
-        // Create transformations
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::rotate(model, (float)glfwGetTime(), glm::vec3(0.5f, 1.0f, 0.0f));
-        
-        glm::mat4 view = glm::mat4(1.0f);
-        view = glm::translate(view, glm::vec3(0.0f, 0.0f, -3.0f));
-        
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
-        
-        // Get matrix's uniform location and set matrices
-        unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
-        unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
-        unsigned int projectionLoc = glGetUniformLocation(shaderProgram, "projection");
-        unsigned int activeSpaceLoc = glGetUniformLocation(shaderProgram, "activeSpace");
-        
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
-        glUniform1i(activeSpaceLoc, activeSpace);
-
-        // Draw the cube
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
-
-        // Display information about the current space
-        std::string spaceInfo;
-        switch (activeSpace) {
-            case MODEL_SPACE:
-                spaceInfo = "MODEL SPACE (Press 1-4 to change)";
-                break;
-            case WORLD_SPACE:
-                spaceInfo = "WORLD SPACE (Press 1-4 to change)";
-                break;
-            case VIEW_SPACE:
-                spaceInfo = "VIEW SPACE (Press 1-4 to change)";
-                break;
-            case CLIP_SPACE:
-                spaceInfo = "CLIP SPACE (Press 1-4 to change)";
-                break;
+                // Frame times with a line at 60 Hz, scaled to 33 ms
+                const float graphHeight = 50.0f;
+                hud.graph(10.0f, y, 320.0f, graphHeight, frameHistory, FRAME_HISTORY, 33.3f, glm::vec4(0.3f, 0.9f, 0.4f, 0.9f));
+                hud.rect(10.0f, y + graphHeight * (1.0f - 16.7f / 33.3f), 320.0f, 1.0f, glm::vec4(1.0f, 0.3f, 0.3f, 0.9f));
+                hud.draw(stream);
+                gpuProfiler.endScope();
+            }
+            stream.endFrame();
+
+            // Swap buffers
+            {
+                TRACE_SCOPE("swap");
+                gpuProfiler.beginScope("swap");
+                platform->swapBuffers();
+                gpuProfiler.endScope();
+                gpuProfiler.endFrame();
+            }
+        }
+        state.endFrame();
+        glCallStatsEndFrame();
+
+        // Frame time is the interval between finished frames, so with a render thread it is
+        // the pipeline's throughput rather than the cost of one side
+        auto frameEnd = std::chrono::steady_clock::now();
+        double frameMs = std::chrono::duration<double, std::milli>(frameEnd - lastFrameEnd).count();
+        lastFrameEnd = frameEnd;
+        lastLatencyMs = std::chrono::duration<double, std::milli>(frameEnd - packet.simulateStart).count();
+        std::copy(frameHistory + 1, frameHistory + FRAME_HISTORY, frameHistory);
+        frameHistory[FRAME_HISTORY - 1] = (float)frameMs;
+        if (benchmarking)
+        {
+            recorder.addFrame(frameMs);
+            simulateSamples.push_back(packet.simulateMs);
+            renderSamples.push_back(std::chrono::duration<double, std::milli>(frameEnd - renderStart).count());
+            latencySamples.push_back(lastLatencyMs);
         }
-        glfwSetWindowTitle(window, ("Vertex Transformation Pipeline - " + spaceInfo).c_str());
+        lastSpace = packet.space;
+        lastSpin = packet.spin;
+        ++frame;
+    };
 
-        // Swap buffers and poll IO events
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+    // By default one thread simulates and renders each frame in turn. With --render-thread
+    // this thread keeps window events and simulation while a render thread owns the context,
+    // so frame N+1 is simulated while frame N renders. Up to PACKETS_IN_FLIGHT packets sit
+    // between the two, which bounds the added latency.
+    const int PACKETS_IN_FLIGHT = 2;
+    uint64_t producerWaits = 0;
+    uint64_t consumerWaits = 0;
+    auto loopStart = std::chrono::steady_clock::now();
+    lastFrameEnd = loopStart;
+    if (options.simulateOnly)
+    {
+        // Throughput of the simulation side alone: packets are built and thrown away
+        FramePacket packet;
+        for (; frame < options.frames; ++frame)
+        {
+            simulateFrame(frame, packet);
+            recorder.addFrame(packet.simulateMs);
+            simulateSamples.push_back(packet.simulateMs);
+            platform->pollEvents();
+        }
+    }
+    else if (!options.renderThread)
+    {
+        FramePacket packet;
+        while (benchmarking ? frame < options.frames : !platform->shouldClose())
+        {
+            TRACE_SCOPE("frame");
+            simulateFrame(frame, packet);
+            renderFrame(packet);
+            {
+                TRACE_SCOPE("poll events");
+                platform->pollEvents();
+            }
+        }
+    }
+    else
+    {
+        SpscRing<FramePacket, PACKETS_IN_FLIGHT> packets;
+
+        // A context is current on at most one thread; hand it over for the length of the loop
+        platform->makeCurrent(false);
+        std::thread renderThread([&]() {
+            TRACE_THREAD_NAME("render");
+            platform->makeCurrent(true);
+            int attempt = 0;
+            while (true)
+            {
+                FramePacket* packet = packets.tryBeginRead();
+                if (!packet)
+                {
+                    if (attempt == 0)
+                        ++consumerWaits;
+                    ringBackoff(attempt++);
+                    continue;
+                }
+                attempt = 0;
+                const bool quit = packet->quit;
+                if (!quit)
+                    renderFrame(*packet);
+                packets.endRead();
+                if (quit)
+                    break;
+            }
+            platform->makeCurrent(false);
+        });
+
+        // Wait for a free slot; the render side frees one every frame
+        auto claimPacket = [&]() {
+            int attempt = 0;
+            FramePacket* packet;
+            while ((packet = packets.tryBeginWrite()) == nullptr)
+            {
+                if (attempt == 0)
+                    ++producerWaits;
+                ringBackoff(attempt++);
+            }
+            return packet;
+        };
+
+        int simulated = 0;
+        while (benchmarking ? simulated < options.frames : !platform->shouldClose())
+        {
+            FramePacket* packet = claimPacket();
+            simulateFrame(simulated, *packet);
+            packets.endWrite();
+            ++simulated;
+            {
+                TRACE_SCOPE("poll events");
+                platform->pollEvents();
+            }
+        }
+        FramePacket* quit = claimPacket();
+        quit->quit = true;
+        packets.endWrite();
+        renderThread.join();
+        platform->makeCurrent(true);
+    }
+    const double loopMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loopStart).count();
+
+    // Let the encoders write out the frames still in flight
+    if (capture.active())
+    {
+        auto finishStart = std::chrono::steady_clock::now();
+        capture.finish();
+        const double finishMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - finishStart).count();
+        const CaptureStats captureStats = capture.stats();
+        if (!options.headless)
+        {
+            std::cout << "Captured " << captureStats.written << " frames to " << options.capturePath << " ("
+                      << captureStats.fenceWaits << " fence waits, " << captureStats.encoderWaits << " encoder waits, "
+                      << captureStats.skipped << " skipped, " << captureStats.failed << " failed)" << std::endl;
+        }
+
+        const double captured = (double)std::max<uint64_t>(captureStats.frames, 1);
+        std::ostringstream section;
+        section << "{ \"path\": \"" << jsonEscape(options.capturePath) << "\""
+                << ", \"frames\": " << captureStats.frames
+                << ", \"written\": " << captureStats.written
+                << ", \"failed\": " << captureStats.failed
+                << ", \"skipped\": " << captureStats.skipped
+                << ", \"pack_buffers\": " << ReadbackRing::BUFFERS
+                << ", \"fence_waits\": " << captureStats.fenceWaits
+                << ", \"encoder_waits\": " << captureStats.encoderWaits
+                << ", \"wait_ms\": " << captureStats.waitMs
+                << ", \"mean_copy_ms\": " << captureStats.copyMs / captured
+                << ", \"mean_encode_ms\": " << captureStats.encodeMs / captured
+                << ", \"drain_ms\": " << finishMs
+                << ", \"bytes\": " << captureStats.bytes << " }";
+        recorder.addSection("capture", section.str());
+    }
+
+    // Every job is done once its image is written, so the batch ends with the capture
+    if (batch.active())
+    {
+        const double batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loopStart).count();
+        std::ostringstream section;
+        writeBatchSummary(section, batch.results(), 1, batchMs);
+        recorder.addSection("batch", section.str());
+#if defined(VP_HAVE_BATCH_PROCESSES)
+        if (options.batchReportFd >= 0)
+            sendBatchResults(options.batchReportFd, batch.results());
+#endif
+    }
+
+#if defined(VP_HAVE_SHM_OUTPUT)
+    if (shmReadback.active())
+    {
+        shmReadback.drain(publishFrame);
+        const ShmWriterStats& shmStats = shmWriter.stats();
+        const ReadbackStats& readbackStats = shmReadback.stats();
+        std::ostringstream section;
+        section << "{ \"published\": " << shmStats.published
+                << ", \"slots\": " << ShmFrameWriter::SLOTS
+                << ", \"consumers\": " << shmStats.consumers
+                << ", \"wakes\": " << shmStats.wakes
+                << ", \"fence_waits\": " << readbackStats.fenceWaits
+                << ", \"wait_ms\": " << readbackStats.waitMs
+                << ", \"mean_copy_ms\": " << shmStats.copyMs / (double)std::max<uint64_t>(shmStats.published, 1) << " }";
+        recorder.addSection("shm_output", section.str());
+    }
+#endif
+
+    // Render the last frame again on the CPU and compare it with what the GPU produced
+    if (options.compareSoftware)
+    {
+        std::vector<uint32_t> glPixels((size_t)sceneTarget->width * (size_t)sceneTarget->height);
+        state.bindFramebuffer(GL_READ_FRAMEBUFFER, sceneTarget->fbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, sceneTarget->width, sceneTarget->height, GL_RGBA, GL_UNSIGNED_BYTE, glPixels.data());
+
+        SoftwareRasterizer raster(frameJobs);
+        raster.resize(sceneTarget->width, sceneTarget->height);
+        renderSceneSoftware(raster, scene, meshes, objectMeshes, lastSpace, perInstance, lastSpin);
+
+        // Rasterization rules differ slightly between implementations, so allow a
+        // little channel noise and a small fraction of differing edge pixels
+        const int tolerance = 2;
+        const double maxMismatch = 0.005;
+        ImageDiff diff = compareImages(glPixels, raster.colorBuffer(), tolerance);
+        const bool match = diff.mismatchFraction() < maxMismatch;
+        std::cout << "Software comparison: " << diff.mismatched << " of " << diff.pixels << " pixels differ ("
+                  << diff.mismatchFraction() * 100.0 << "%), max channel difference " << diff.maxChannelDiff
+                  << (match ? ", MATCH" : ", MISMATCH") << std::endl;
+
+        std::ostringstream section;
+        section << "{ \"tolerance\": " << tolerance
+                << ", \"pixels\": " << diff.pixels
+                << ", \"mismatched\": " << diff.mismatched
+                << ", \"mismatch_fraction\": " << diff.mismatchFraction()
+                << ", \"max_channel_diff\": " << diff.maxChannelDiff
+                << ", \"match\": " << (match ? "true" : "false") << " }";
+        recorder.addSection("software_compare", section.str());
+    }
+
+    // Report frame statistics
+    if (benchmarking)
+    {
+        gpuProfiler.collect(true, recordGpuTime);
+        recorder.addSection("gpu_passes_ms", gpuProfiler.summaryJson());
+
+        std::ostringstream cullSection;
+        cullSection << "{ \"enabled\": " << (options.cull ? "true" : "false")
+                    << ", \"kernel\": \"" << kernelName(cullKernel) << "\""
+                    << ", \"threads\": " << frameJobs.threadCount()
+                    << ", \"mean_visible\": " << visibleTotal / (double)frame
+                    << ", \"mean_ms\": " << cullMsTotal / (double)frame << " }";
+        recorder.addSection("culling", cullSection.str());
+
+        const StreamStats& streamStats = stream.stats();
+        std::ostringstream streamSection;
+        streamSection << "{ \"persistent\": " << (stream.persistent() ? "true" : "false")
+                      << ", \"region_bytes\": " << stream.regionSize()
+                      << ", \"frames_in_flight\": " << StreamBuffer::FRAMES
+                      << ", \"frames\": " << streamStats.frames
+                      << ", \"fence_waits\": " << streamStats.fenceWaits
+                      << ", \"wait_ms\": " << streamStats.waitMs
+                      << ", \"overflows\": " << streamStats.overflows
+                      << ", \"peak_bytes\": " << streamStats.peakBytes << " }";
+        recorder.addSection("stream_buffer", streamSection.str());
+
+        const GlStateStats& stateTotals = state.total();
+        const double stateFrames = (double)std::max<uint64_t>(state.frames(), 1);
+        std::ostringstream stateSection;
+        stateSection << "{ \"issued_per_frame\": " << (double)stateTotals.issued / stateFrames
+                     << ", \"elided_per_frame\": " << (double)stateTotals.elided / stateFrames
+                     << ", \"issued\": " << stateTotals.issued
+                     << ", \"elided\": " << stateTotals.elided << " }";
+        recorder.addSection("gl_state", stateSection.str());
+        if (glCallStatsEnabled())
+            recorder.addSection("gl_calls", glCallStatsSummaryJson());
+
+        std::ostringstream pipelineSection;
+        const char* mode = options.simulateOnly ? "simulate_only" : options.renderThread ? "render_thread" : "single_thread";
+        pipelineSection << "{ \"mode\": \"" << mode << "\""
+                        << ", \"packets_in_flight\": " << (options.renderThread ? PACKETS_IN_FLIGHT : 1)
+                        << ", \"fps\": " << (double)frame * 1000.0 / loopMs
+                        << ", \"producer_waits\": " << producerWaits
+                        << ", \"consumer_waits\": " << consumerWaits
+                        << ", \"simulate_ms\": ";
+        writeTimingSummary(pipelineSection, summarize(simulateSamples));
+        pipelineSection << ", \"render_ms\": ";
+        writeTimingSummary(pipelineSection, summarize(renderSamples));
+        pipelineSection << ", \"latency_ms\": ";
+        writeTimingSummary(pipelineSection, summarize(latencySamples));
+        pipelineSection << " }";
+        recorder.addSection("pipeline", pipelineSection.str());
+
+        const SimStats& simStats = simulation.stats();
+        std::ostringstream simSection;
+        simSection << "{ \"rate_hz\": " << simulation.rate()
+                   << ", \"steps\": " << simStats.steps
+                   << ", \"steps_per_frame\": " << (double)simStats.steps / (double)std::max<uint64_t>(simStats.advances, 1)
+                   << ", \"steps_per_second\": " << (double)simStats.steps * 1000.0 / loopMs
+                   << ", \"dropped_steps\": " << simStats.droppedSteps
+                   << ", \"simulated_seconds\": " << simulation.state().time << " }";
+        recorder.addSection("simulation", simSection.str());
+
+        if (shaderReloader.active())
+        {
+            const ShaderReloadStats& reloadStats = shaderReloader.stats();
+            std::ostringstream reloadSection;
+            reloadSection << "{ \"reloads\": " << reloadStats.reloads
+                          << ", \"failures\": " << reloadStats.failures
+                          << ", \"compile_ms\": " << reloadStats.compileMs
+                          << ", \"max_swap_ms\": " << reloadStats.maxSwapMs
+                          << ", \"last_latency_ms\": " << reloadStats.lastLatencyMs << " }";
+            recorder.addSection("shader_reload", reloadSection.str());
+        }
+
+        std::string renderer = (const char*)glGetString(GL_RENDERER);
+        std::string version = (const char*)glGetString(GL_VERSION);
+        recorder.setPlatformVersion(platform->apiVersion());
+        if (options.outputPath.empty())
+        {
+            // Batch workers leave stdout to the parent's aggregate report
+            if (options.batchReportFd < 0)
+                recorder.writeJson(std::cout, options, renderer, version);
+        }
+        else
+        {
+            std::ofstream file(options.outputPath);
+            if (!file)
+                std::cout << "ERROR::BENCHMARK::CANNOT_WRITE " << options.outputPath << std::endl;
+            else
+                recorder.writeJson(file, options, renderer, version);
+        }
+    }
+
+    if (!options.tracePath.empty())
+    {
+        traceStop();
+        traceWriteJson(options.tracePath);
     }
 
     // Cleanup
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteProgram(shaderProgram);
+    shaderReloader.destroy();
+    capture.destroy();
+    shmReadback.destroy();
+#if defined(VP_HAVE_SHM_OUTPUT)
+    shmWriter.destroy();
+#endif
+    gpuProfiler.destroy();
+    if (!options.headless)
+        hud.destroy();
+    targetPool.destroy();
+    meshes.destroy();
+    if (instanceBuffer)
+        glDeleteBuffers(1, &instanceBuffer);
+    spacePrograms.destroy();
+    stream.destroy();
 
-    glfwTerminate();
+    platform->destroy();
     return 0;
 }
 
-// Process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
-void processInput(GLFWwindow* window)
+// Process all input: query the platform whether relevant keys are pressed this frame and react accordingly
+void processInput(Platform& platform)
 {
-    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
-        glfwSetWindowShouldClose(window, true);
+    TRACE_SCOPE("input");
+    if (platform.keyDown(PLATFORM_KEY_ESCAPE))
+        platform.requestClose();
 }
 
-// GLFW: whenever the window size changed (by OS or user resize) this callback function executes
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+// Whenever the window size changed (by OS or user resize) this callback function executes.
+// Only record the size; the render loop resizes its target and projection once per frame.
+void framebuffer_size_callback(int width, int height)
 {
-    glViewport(0, 0, width, height);
+    framebufferWidth = width;
+    framebufferHeight = height;
+    framebufferResized = true;
 }
 
-// GLFW: whenever a key is pressed, this callback is called
-void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+// Whenever a key is pressed, this callback is called
+void key_callback(int key)
 {
-    if (action == GLFW_PRESS) {
-        switch (key) {
-            case GLFW_KEY_1:
-                activeSpace = MODEL_SPACE;
-                break;
-            case GLFW_KEY_2:
-                activeSpace = WORLD_SPACE;
-                break;
-            case GLFW_KEY_3:
-                activeSpace = VIEW_SPACE;
-                break;
-            case GLFW_KEY_4:
-                activeSpace = CLIP_SPACE;
-                break;
-        }
+    switch (key) {
+        case '1':
+            activeSpace = MODEL_SPACE;
+            break;
+        case '2':
+            activeSpace = WORLD_SPACE;
+            break;
+        case '3':
+            activeSpace = VIEW_SPACE;
+            break;
+        case '4':
+            activeSpace = CLIP_SPACE;
+            break;
     }
 }
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include "mesh.h"
+#include "gl_state.h"
+
+#include <glad/glad.h>
+
+MeshData makeCube()
+{
+    MeshData mesh;
+    mesh.positions = {
+        // Front face
+        -0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,
+
+        // Back face
+        -0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,
+        -0.5f,  0.5f, -0.5f
+    };
+
+    mesh.indices = {
+        // Front face
+        0, 1, 2,
+        2, 3, 0,
+
+        // Right face
+        1, 5, 6,
+        6, 2, 1,
+
+        // Back face
+        5, 4, 7,
+        7, 6, 5,
+
+        // Left face
+        4, 0, 3,
+        3, 7, 4,
+
+        // Top face
+        3, 2, 6,
+        6, 7, 3,
+
+        // Bottom face
+        4, 5, 1,
+        1, 0, 4
+    };
+    return mesh;
+}
+
+MeshData makePyramid()
+{
+    MeshData mesh;
+    mesh.positions = {
+        // Base
+        -0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f, -0.5f,
+        -0.5f, -0.5f, -0.5f,
+
+        // Apex
+         0.0f,  0.5f,  0.0f
+    };
+
+    mesh.indices = {
+        // Sides
+        0, 1, 4,
+        1, 2, 4,
+        2, 3, 4,
+        3, 0, 4,
+
+        // Base
+        0, 3, 2,
+        2, 1, 0
+    };
+    return mesh;
+}
+
+MeshData makeOctahedron()
+{
+    MeshData mesh;
+    mesh.positions = {
+         0.6f,  0.0f,  0.0f,
+        -0.6f,  0.0f,  0.0f,
+         0.0f,  0.6f,  0.0f,
+         0.0f, -0.6f,  0.0f,
+         0.0f,  0.0f,  0.6f,
+         0.0f,  0.0f, -0.6f
+    };
+
+    mesh.indices = {
+        // Upper half
+        4, 0, 2,
+        0, 5, 2,
+        5, 1, 2,
+        1, 4, 2,
+
+        // Lower half
+        0, 4, 3,
+        5, 0, 3,
+        1, 5, 3,
+        4, 1, 3
+    };
+    return mesh;
+}
+
+int MeshRegistry::add(const MeshData& mesh)
+{
+    MeshRange range;
+    range.firstIndex = (unsigned int)packedIndices.size();
+    range.indexCount = (unsigned int)mesh.indices.size();
+    range.baseVertex = (int)(packedPositions.size() / 3);
+    range.vertexCount = (unsigned int)(mesh.positions.size() / 3);
+
+    packedPositions.insert(packedPositions.end(), mesh.positions.begin(), mesh.positions.end());
+    packedIndices.insert(packedIndices.end(), mesh.indices.begin(), mesh.indices.end());
+    ranges.push_back(range);
+    return (int)ranges.size() - 1;
+}
+
+void MeshRegistry::upload()
+{
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glState().bindVertexArray(VAO);
+
+    glState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)(packedPositions.size() * sizeof(float)), packedPositions.data(), GL_STATIC_DRAW);
+
+    // The index buffer binding is part of the VAO, so it bypasses the state cache
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)(packedIndices.size() * sizeof(unsigned int)), packedIndices.data(), GL_STATIC_DRAW);
+
+    // Position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+}
+
+void MeshRegistry::destroy()
+{
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    VAO = VBO = EBO = 0;
+}
@@ -0,0 +1,56 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <vector>
+
+// Positions (xyz) and triangle indices of one mesh on the CPU
+struct MeshData
+{
+    std::vector<float> positions;
+    std::vector<unsigned int> indices;
+};
+
+MeshData makeCube();
+MeshData makePyramid();
+MeshData makeOctahedron();
+
+// Where a mesh lives inside the shared buffers
+struct MeshRange
+{
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+    int baseVertex = 0;
+    unsigned int vertexCount = 0;
+};
+
+// Packs every mesh into one vertex buffer and one index buffer behind a single VAO,
+// so any mix of meshes can be drawn without rebinding anything.
+// Indices stay relative to their own mesh; draws add baseVertex.
+class MeshRegistry
+{
+public:
+    // Append a mesh before upload(); returns its id
+    int add(const MeshData& mesh);
+
+    // Create the VAO and the shared buffers from everything added so far
+    void upload();
+    void destroy();
+
+    int count() const { return (int)ranges.size(); }
+    const MeshRange& range(int id) const { return ranges[id]; }
+
+    // CPU copies of the packed data, for paths that do not go through GL
+    const std::vector<float>& positions() const { return packedPositions; }
+    const std::vector<unsigned int>& indices() const { return packedIndices; }
+
+    unsigned int VAO = 0;
+    unsigned int VBO = 0;
+    unsigned int EBO = 0;
+
+private:
+    std::vector<MeshRange> ranges;
+    std::vector<float> packedPositions;
+    std::vector<unsigned int> packedIndices;
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include "options.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Read a positive integer argument, failing on garbage or out of range values
+static bool readInt(const char* text, long minValue, long maxValue, long& value)
+{
+    char* end = nullptr;
+    value = std::strtol(text, &end, 10);
+    return end != text && *end == '\0' && value >= minValue && value <= maxValue;
+}
+
+// Read "I/N" with 0 <= I < N
+static bool readShard(const char* text, int& index, int& count)
+{
+    int used = 0;
+    return std::sscanf(text, "%d/%d%n", &index, &count, &used) == 2 && text[used] == '\0' &&
+           count >= 1 && index >= 0 && index < count;
+}
+
+void printUsage(const char* program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --headless          render offscreen on a hidden window and print frame statistics\n"
+              << "  --platform NAME     glfw (default), egl or osmesa; egl and osmesa need no display server and require --headless\n"
+              << "  --frames N          render N frames then exit (default: 300 when headless)\n"
+              << "  --width W           framebuffer width (default: " << SCR_WIDTH << ")\n"
+              << "  --height H          framebuffer height (default: " << SCR_HEIGHT << ")\n"
+              << "  --objects N         number of cubes in the scene (default: 1)\n"
+              << "  --instanced         draw all cubes with a single instanced draw call\n"
+              << "  --multi-draw        mix several meshes and submit them with glMultiDrawElementsIndirect\n"
+              << "  --output FILE       write the benchmark JSON to FILE instead of stdout\n"
+              << "  --shader-cache DIR  store linked program binaries in DIR (default: .shader_cache)\n"
+              << "  --no-shader-cache   always compile shaders from source\n"
+              << "  --shader-dir DIR    read scene.vert and scene.frag from DIR (default: " << VP_SHADER_DIR << ")\n"
+              << "  --watch-shaders     recompile the scene shaders in the background when their files change\n"
+              << "  --no-cull           submit every object, even those outside the view frustum\n"
+              << "  --capture FILE      write every frame as numbered PNG/PPM files or one Y4M video, by extension\n"
+              << "  --capture-threads N encoder threads for --capture (default: half the hardware threads)\n"
+              << "  --shm-output SOCKET publish frames to a shared-memory ring; consumers connect to SOCKET (Linux)\n"
+              << "  --batch FILE        render each camera job in FILE once and exit; needs --headless and --capture\n"
+              << "  --batch-processes N split --batch across N processes with a context each (default: 1)\n"
+              << "  --shard I/N         --batch renders only every N-th job starting at I, to spread a list over machines\n"
+              << "  --trace FILE        record the CPU frame timeline and write it as Chrome trace JSON\n"
+              << "  --renderer NAME     gl (default) or software; software requires --headless\n"
+              << "  --threads N         worker threads for culling, transforms and the software rasterizer (default: all)\n"
+              << "  --render-thread     simulate on the main thread and render on a separate thread\n"
+              << "  --sim-rate HZ       fixed simulation steps per second, independent of the frame rate (default: 120)\n"
+              << "  --simulate-only     headless: run the simulation as fast as possible without rendering\n"
+              << "  --compare-software  compare the last headless GL frame with the software rasterizer\n"
+              << "  --bench NAME        run an offline benchmark and exit (transform, raster, cull, queue, jobs, shm)\n"
+              << "  --bench-size N      problem size for --bench (default depends on the benchmark)\n"
+              << "  --help              show this message" << std::endl;
+}
+
+bool parseOptions(int argc, char** argv, Options& options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        long value = 0;
+
+        if (std::strcmp(arg, "--headless") == 0) {
+            options.headless = true;
+        }
+        else if (std::strcmp(arg, "--platform") == 0 && hasValue && parsePlatformName(argv[i + 1], options.platform)) {
+            ++i;
+        }
+        else if (std::strcmp(arg, "--frames") == 0 && hasValue && readInt(argv[i + 1], 1, 100000000, value)) {
+            options.frames = (int)value;
+            ++i;
+        }
+        else if (std::strcmp(arg, "--width") == 0 && hasValue && readInt(argv[i + 1], 1, 16384, value)) {
+            options.width = (unsigned int)value;
+            ++i;
+        }
+        else if (std::strcmp(arg, "--height") == 0 && hasValue && readInt(argv[i + 1], 1, 16384, value)) {
+            options.height = (unsigned int)value;
+            ++i;
+        }
+        else if (std::strcmp(arg, "--objects") == 0 && hasValue && readInt(argv[i + 1], 1, 100000000, value)) {
+            options.objects = (int)value;
+            ++i;
+        }
+        else if (std::strcmp(arg, "--instanced") == 0) {
+            options.instanced = true;
+        }
+        else if (std::strcmp(arg, "--multi-draw") == 0) {
+            options.multiDraw = true;
+        }
+        else if (std::strcmp(arg, "--output") == 0 && hasValue) {
+            options.outputPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--shader-cache") == 0 && hasValue) {
+            options.shaderCache = argv[++i];
+        }
+        else if (std::strcmp(arg, "--no-shader-cache") == 0) {
+            options.shaderCache.clear();
+        }
+        else if (std::strcmp(arg, "--shader-dir") == 0 && hasValue) {
+            options.shaderDir = argv[++i];
+        }
+        else if (std::strcmp(arg, "--watch-shaders") == 0) {
+            options.watchShaders = true;
+        }
+        else if (std::strcmp(arg, "--trace") == 0 && hasValue) {
+            options.tracePath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--capture") == 0 && hasValue) {
+            options.capturePath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--capture-threads") == 0 && hasValue && readInt(argv[i + 1], 1, 256, value)) {
+            options.captureThreads = (int)value;
+            ++i;
+        }
+        else if (std::strcmp(arg, "--shm-output") == 0 && hasValue) {
+            options.shmPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--batch") == 0 && hasValue) {
+            options.batchPath = argv[++i];
+        }
+        else if (std::strcmp(arg, "--batch-processes") == 0 && hasValue && readInt(argv[i + 1], 1, 1024, value)) {
+            options.batchProcesses = (int)value;
+            ++i;
+        }
+        else if (std::strcmp(arg, "--shard") == 0 && hasValue && readShard(argv[i + 1], options.shardIndex, options.shardCount)) {
+            ++i;
+        }
+        else if (std::strcmp(arg, "--no-cull") == 0) {
+            options.cull = false;
+        }
+        else if (std::strcmp(arg, "--renderer") == 0 && hasValue &&
+                 (std::strcmp(argv[i + 1], "gl") == 0 || std::strcmp(argv[i + 1], "software") == 0)) {
+            options.software = std::strcmp(argv[++i], "software") == 0;
+        }
+        else if (std::strcmp(arg, "--threads") == 0 && hasValue && readInt(argv[i + 1], 1, 1024, value)) {
+            options.threads = (int)value;
+            ++i;
+        }
+        else if (std::strcmp(arg, "--render-thread") == 0) {
+            options.renderThread = true;
+        }
+        else if (std::strcmp(arg, "--sim-rate") == 0 && hasValue && readInt(argv[i + 1], 1, 100000, value)) {
+            options.simRate = (int)value;
+            ++i;
+        }
+        else if (std::strcmp(arg, "--simulate-only") == 0) {
+            options.simulateOnly = true;
+        }
+        else if (std::strcmp(arg, "--compare-software") == 0) {
+            options.compareSoftware = true;
+        }
+        else if (std::strcmp(arg, "--bench") == 0 && hasValue) {
+            options.bench = argv[++i];
+        }
+        else if (std::strcmp(arg, "--bench-size") == 0 && hasValue && readInt(argv[i + 1], 1, 1000000000, value)) {
+            options.benchSize = value;
+            ++i;
+        }
+        else {
+            if (std::strcmp(arg, "--help") != 0)
+                std::cout << "ERROR::OPTIONS::INVALID_ARGUMENT " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.instanced && options.multiDraw)
+    {
+        std::cout << "ERROR::OPTIONS::--instanced and --multi-draw cannot be combined" << std::endl;
+        return false;
+    }
+
+    if (options.platform != PLATFORM_GLFW && !options.headless)
+    {
+        std::cout << "ERROR::OPTIONS::--platform " << platformName(options.platform) << " has no window and needs --headless" << std::endl;
+        return false;
+    }
+
+    if (options.software && !options.headless)
+    {
+        std::cout << "ERROR::OPTIONS::--renderer software needs --headless" << std::endl;
+        return false;
+    }
+
+    if (options.compareSoftware && (!options.headless || options.software))
+    {
+        std::cout << "ERROR::OPTIONS::--compare-software needs a headless GL run" << std::endl;
+        return false;
+    }
+
+    if (options.simulateOnly && (!options.headless || options.software || options.renderThread || options.compareSoftware))
+    {
+        std::cout << "ERROR::OPTIONS::--simulate-only needs a headless GL run without --render-thread or --compare-software" << std::endl;
+        return false;
+    }
+
+    if ((!options.capturePath.empty() || !options.shmPath.empty()) && (options.software || options.simulateOnly))
+    {
+        std::cout << "ERROR::OPTIONS::--capture and --shm-output need GL rendering; they cannot be combined with --renderer software or --simulate-only" << std::endl;
+        return false;
+    }
+
+    if (options.watchShaders && (options.software || options.simulateOnly))
+    {
+        std::cout << "ERROR::OPTIONS::--watch-shaders needs GL rendering" << std::endl;
+        return false;
+    }
+
+    if (!options.batchPath.empty())
+    {
+        // The jobs' images are what a batch produces
+        if (!options.headless || options.software || options.simulateOnly || options.capturePath.empty() || options.frames != 0)
+        {
+            std::cout << "ERROR::OPTIONS::--batch needs a headless GL run with --capture, and renders each job once (no --frames)" << std::endl;
+            return false;
+        }
+        // The software renderer draws the scene's own camera, not the jobs'
+        if (options.compareSoftware)
+        {
+            std::cout << "ERROR::OPTIONS::--compare-software cannot be combined with --batch" << std::endl;
+            return false;
+        }
+    }
+    else if (options.batchProcesses > 1 || options.shardCount > 1)
+    {
+        std::cout << "ERROR::OPTIONS::--batch-processes and --shard need --batch" << std::endl;
+        return false;
+    }
+
+    // Headless runs always terminate
+    if (options.headless && options.frames == 0)
+        options.frames = 300;
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include "platform.h"
+
+#include <string>
+
+// Scene shader sources; the build points this at the source tree
+#if !defined(VP_SHADER_DIR)
+#define VP_SHADER_DIR "shaders"
+#endif
+
+// Window dimensions used when nothing is given on the command line
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// Settings taken from the command line
+struct Options
+{
+    bool headless = false;          // render into an offscreen framebuffer on a hidden window
+    PlatformBackend platform = PLATFORM_GLFW;   // how the GL context is created
+    int frames = 0;                 // number of frames to render before exiting (0 = run until closed)
+    unsigned int width = SCR_WIDTH;
+    unsigned int height = SCR_HEIGHT;
+    int objects = 1;                // number of cubes in the scene
+    bool instanced = false;         // draw every cube with one instanced draw call
+    bool multiDraw = false;         // mixed meshes submitted with one multi-draw indirect call
+    std::string outputPath;         // where to write the benchmark JSON (empty = stdout)
+    std::string shaderCache = ".shader_cache";  // program binary cache directory (empty = disabled)
+    std::string shaderDir = VP_SHADER_DIR;      // where scene.vert and scene.frag are read from
+    bool watchShaders = false;      // rebuild the scene shaders in the background when their files change
+    bool cull = true;               // skip objects whose bounding sphere is outside the view frustum
+    bool software = false;          // render with the built-in software rasterizer (headless only)
+    int threads = 0;                // worker threads for CPU work (0 = all hardware threads)
+    bool renderThread = false;      // simulate on the main thread, render on a second thread
+    int simRate = 120;              // fixed simulation steps per second
+    bool simulateOnly = false;      // headless: run the simulation as fast as possible, draw nothing
+    bool compareSoftware = false;   // check the last GL frame against the software rasterizer
+    std::string capturePath;        // write every rendered frame here (.png, .ppm or .y4m; empty = off)
+    int captureThreads = 0;         // encoder threads for --capture (0 = half the hardware threads)
+    std::string shmPath;            // publish frames to a shared-memory ring served on this socket (empty = off)
+    std::string batchPath;          // render every job of this list instead of an animation (empty = off)
+    int batchProcesses = 1;         // worker processes for --batch, each with its own context
+    int shardIndex = 0;             // --batch renders only jobs with index % shardCount == shardIndex
+    int shardCount = 1;
+    int batchReportFd = -1;         // set in --batch-processes workers: where their results go
+    std::string tracePath;          // write a Chrome trace of the CPU timeline here (empty = off)
+    std::string bench;              // offline benchmark to run instead of rendering (empty = none)
+    long benchSize = 0;             // problem size for the offline benchmark (0 = its default)
+};
+
+// Parse argv into options. Returns false (after printing usage) on bad input or --help.
+bool parseOptions(int argc, char** argv, Options& options);
+void printUsage(const char* program);
+
+#endif
@@ -0,0 +1,73 @@
+#include "platform.h"
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+namespace
+{
+    // glad takes a plain function; route it to the platform being loaded
+    Platform* loadingPlatform = nullptr;
+
+    void* loadProc(const char* name)
+    {
+        return loadingPlatform->procAddress(name);
+    }
+}
+
+bool Platform::loadGL()
+{
+    loadingPlatform = this;
+    const bool loaded = gladLoadGLLoader((GLADloadproc)loadProc) != 0;
+    loadingPlatform = nullptr;
+    return loaded;
+}
+
+const char* platformName(PlatformBackend backend)
+{
+    switch (backend) {
+        case PLATFORM_GLFW:
+            return "glfw";
+        case PLATFORM_EGL:
+            return "egl";
+        case PLATFORM_OSMESA:
+            return "osmesa";
+    }
+    return "unknown";
+}
+
+bool parsePlatformName(const std::string& name, PlatformBackend& backend)
+{
+    for (PlatformBackend candidate : { PLATFORM_GLFW, PLATFORM_EGL, PLATFORM_OSMESA })
+    {
+        if (name == platformName(candidate))
+        {
+            backend = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::unique_ptr<Platform> createPlatform(PlatformBackend backend)
+{
+    switch (backend) {
+        case PLATFORM_GLFW:
+            return createGlfwPlatform();
+        case PLATFORM_EGL:
+#if defined(VP_HAVE_EGL)
+            return createEglPlatform();
+#else
+            break;
+#endif
+        case PLATFORM_OSMESA:
+#if defined(VP_HAVE_OSMESA)
+            return createOsMesaPlatform();
+#else
+            break;
+#endif
+    }
+    std::cout << "ERROR::PLATFORM::NOT_COMPILED_IN " << platformName(backend)
+              << " (its library was not found when this build was configured)" << std::endl;
+    return nullptr;
+}
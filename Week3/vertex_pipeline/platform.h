@@ -0,0 +1,88 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <memory>
+#include <string>
+
+// How the GL context is created (--platform)
+enum PlatformBackend
+{
+    PLATFORM_GLFW,          // a window, hidden when headless; needs a display server
+    PLATFORM_EGL,           // surfaceless EGL: no display server, no default framebuffer
+    PLATFORM_OSMESA         // Mesa's off-screen software context (llvmpipe)
+};
+
+// Key codes follow GLFW: printable keys are their ASCII code
+const int PLATFORM_KEY_ESCAPE = 256;
+
+// A second context that shares objects (programs, buffers, textures) with the platform's
+// own, for a background thread. Created and destroyed on the main thread, made current on
+// the thread that uses it. Container objects such as vertex arrays and framebuffers are
+// not shared.
+class SharedContext
+{
+public:
+    virtual ~SharedContext() {}
+    virtual bool makeCurrent(bool current) = 0;
+};
+
+typedef void (*PlatformResizeCallback)(int width, int height);
+typedef void (*PlatformKeyCallback)(int key);
+
+// Window system and GL context behind the renderer. Every backend gives an OpenGL 3.3 core
+// context; the ones without a window draw only into framebuffer objects, which is what
+// headless runs do anyway, so the rendering code does not know which one it runs on.
+class Platform
+{
+public:
+    virtual ~Platform() {}
+
+    // Create the context at width x height and make it current on the calling thread
+    virtual bool init(int width, int height, bool visible, const char* title) = 0;
+    virtual void destroy() = 0;
+
+    // Make the context current on the calling thread, or release it from this thread
+    virtual void makeCurrent(bool current) = 0;
+    virtual void* procAddress(const char* name) = 0;
+
+    // Version of the context API underneath GL, e.g. "EGL 1.5 (Mesa Project)"; empty when
+    // the backend has nothing to add to GL_VERSION
+    virtual std::string apiVersion() const { return std::string(); }
+
+    // Load GL entry points through this platform; the context must be current
+    bool loadGL();
+
+    // Another context sharing this one's objects, or null (with an error printed) on failure
+    virtual std::unique_ptr<SharedContext> createSharedContext() = 0;
+
+    virtual void framebufferSize(int& width, int& height) = 0;
+    virtual double time() = 0;                  // seconds since init
+    virtual bool shouldClose() = 0;
+    virtual void requestClose() = 0;
+    virtual bool keyDown(int key) = 0;
+    // Deliver input and resize events to the callbacks, on the calling thread
+    virtual void pollEvents() = 0;
+    virtual void swapBuffers() = 0;
+    virtual void setTitle(const char* title) = 0;
+
+    void setResizeCallback(PlatformResizeCallback callback) { resizeCallback = callback; }
+    void setKeyCallback(PlatformKeyCallback callback) { keyCallback = callback; }
+
+protected:
+    PlatformResizeCallback resizeCallback = nullptr;
+    PlatformKeyCallback keyCallback = nullptr;
+};
+
+// Name used on the command line, e.g. "egl"
+const char* platformName(PlatformBackend backend);
+bool parsePlatformName(const std::string& name, PlatformBackend& backend);
+
+// Creates the backend, or returns null (with an error printed) when it was not compiled in
+std::unique_ptr<Platform> createPlatform(PlatformBackend backend);
+
+// Each backend lives in its own translation unit, built only when its library is found
+std::unique_ptr<Platform> createGlfwPlatform();
+std::unique_ptr<Platform> createEglPlatform();
+std::unique_ptr<Platform> createOsMesaPlatform();
+
+#endif
@@ -0,0 +1,202 @@
+#include "platform.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace
+{
+    bool hasExtension(const char* extensions, const char* name)
+    {
+        if (!extensions)
+            return false;
+        const size_t length = std::strlen(name);
+        for (const char* at = std::strstr(extensions, name); at; at = std::strstr(at + length, name))
+        {
+            if ((at == extensions || at[-1] == ' ') && (at[length] == ' ' || at[length] == '\0'))
+                return true;
+        }
+        return false;
+    }
+
+    class EglSharedContext : public SharedContext
+    {
+    public:
+        EglSharedContext(EGLDisplay display, EGLContext context) : display(display), context(context) {}
+        ~EglSharedContext() override { eglDestroyContext(display, context); }
+
+        bool makeCurrent(bool current) override
+        {
+            return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, current ? context : EGL_NO_CONTEXT);
+        }
+
+    private:
+        EGLDisplay display;
+        EGLContext context;
+    };
+
+    const EGLint CONTEXT_ATTRIBS[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+
+    // Surfaceless EGL: a core context with no window, no pbuffer and no display server.
+    // Everything is drawn into framebuffer objects; there is nothing to swap or poll.
+    class EglPlatform : public Platform
+    {
+    public:
+        bool init(int width, int height, bool visible, const char*) override
+        {
+            if (visible)
+            {
+                std::cout << "ERROR::PLATFORM::EGL_HAS_NO_WINDOW" << std::endl;
+                return false;
+            }
+            this->width = width;
+            this->height = height;
+
+            display = openDisplay();
+            EGLint major = 0, minor = 0;
+            if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+            {
+                std::cout << "ERROR::PLATFORM::EGL_NO_DISPLAY 0x" << std::hex << eglGetError() << std::dec << std::endl;
+                display = EGL_NO_DISPLAY;
+                return false;
+            }
+            if (!hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context"))
+            {
+                std::cout << "ERROR::PLATFORM::EGL_NO_SURFACELESS_CONTEXT" << std::endl;
+                destroy();
+                return false;
+            }
+
+            const EGLint configAttribs[] = {
+                EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+                EGL_SURFACE_TYPE, 0,
+                EGL_NONE
+            };
+            EGLint configCount = 0;
+            if (!eglBindAPI(EGL_OPENGL_API) ||
+                !eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+            {
+                std::cout << "ERROR::PLATFORM::EGL_NO_CONFIG 0x" << std::hex << eglGetError() << std::dec << std::endl;
+                destroy();
+                return false;
+            }
+
+            context = eglCreateContext(display, config, EGL_NO_CONTEXT, CONTEXT_ATTRIBS);
+            if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+            {
+                std::cout << "ERROR::PLATFORM::EGL_CONTEXT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+                destroy();
+                return false;
+            }
+            version = "EGL " + std::to_string(major) + "." + std::to_string(minor) + " (" + eglQueryString(display, EGL_VENDOR) + ")";
+            start = std::chrono::steady_clock::now();
+            return true;
+        }
+
+        std::unique_ptr<SharedContext> createSharedContext() override
+        {
+            EGLContext shared = eglCreateContext(display, config, context, CONTEXT_ATTRIBS);
+            if (shared == EGL_NO_CONTEXT)
+            {
+                std::cout << "ERROR::PLATFORM::EGL_SHARED_CONTEXT_FAILED 0x" << std::hex << eglGetError() << std::dec << std::endl;
+                return nullptr;
+            }
+            return std::unique_ptr<SharedContext>(new EglSharedContext(display, shared));
+        }
+
+        void destroy() override
+        {
+            if (display == EGL_NO_DISPLAY)
+                return;
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (context != EGL_NO_CONTEXT)
+                eglDestroyContext(display, context);
+            eglTerminate(display);
+            eglReleaseThread();
+            context = EGL_NO_CONTEXT;
+            display = EGL_NO_DISPLAY;
+        }
+
+        void makeCurrent(bool current) override
+        {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, current ? context : EGL_NO_CONTEXT);
+        }
+
+        void* procAddress(const char* name) override
+        {
+            return (void*)eglGetProcAddress(name);
+        }
+
+        std::string apiVersion() const override { return version; }
+
+        void framebufferSize(int& width, int& height) override
+        {
+            width = this->width;
+            height = this->height;
+        }
+
+        double time() override
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        bool shouldClose() override { return closeRequested; }
+        void requestClose() override { closeRequested = true; }
+        bool keyDown(int) override { return false; }
+        void pollEvents() override {}
+        void swapBuffers() override {}
+        void setTitle(const char*) override {}
+
+    private:
+        // Prefer a display that needs no window system: Mesa's surfaceless platform, then the
+        // first GPU device, then whatever the default display is
+        EGLDisplay openDisplay()
+        {
+            const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+            PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+                (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+            if (getPlatformDisplay && hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+            {
+                EGLDisplay surfaceless = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+                if (surfaceless != EGL_NO_DISPLAY)
+                    return surfaceless;
+            }
+            PFNEGLQUERYDEVICESEXTPROC queryDevices = (PFNEGLQUERYDEVICESEXTPROC)eglGetProcAddress("eglQueryDevicesEXT");
+            if (getPlatformDisplay && queryDevices && hasExtension(clientExtensions, "EGL_EXT_platform_device"))
+            {
+                EGLDeviceEXT device;
+                EGLint deviceCount = 0;
+                if (queryDevices(1, &device, &deviceCount) && deviceCount > 0)
+                {
+                    EGLDisplay deviceDisplay = getPlatformDisplay(EGL_PLATFORM_DEVICE_EXT, device, NULL);
+                    if (deviceDisplay != EGL_NO_DISPLAY)
+                        return deviceDisplay;
+                }
+            }
+            return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        EGLDisplay display = EGL_NO_DISPLAY;
+        EGLConfig config = nullptr;
+        EGLContext context = EGL_NO_CONTEXT;
+        int width = 0;
+        int height = 0;
+        bool closeRequested = false;
+        std::string version;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+std::unique_ptr<Platform> createEglPlatform()
+{
+    return std::unique_ptr<Platform>(new EglPlatform());
+}
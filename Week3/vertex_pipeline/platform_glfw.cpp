@@ -0,0 +1,146 @@
+#include "platform.h"
+
+#include <GLFW/glfw3.h>
+
+#include <iostream>
+
+namespace
+{
+    // A hidden 1x1 window, which is the only way GLFW makes a context
+    class GlfwSharedContext : public SharedContext
+    {
+    public:
+        explicit GlfwSharedContext(GLFWwindow* window) : window(window) {}
+        ~GlfwSharedContext() override { glfwDestroyWindow(window); }
+
+        bool makeCurrent(bool current) override
+        {
+            glfwMakeContextCurrent(current ? window : NULL);
+            return true;
+        }
+
+    private:
+        GLFWwindow* window;
+    };
+
+    class GlfwPlatform : public Platform
+    {
+    public:
+        bool init(int width, int height, bool visible, const char* title) override
+        {
+            glfwInit();
+            setContextHints();
+            if (!visible)
+                glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+            window = glfwCreateWindow(width, height, title, NULL, NULL);
+            if (window == NULL)
+            {
+                std::cout << "ERROR::PLATFORM::GLFW_WINDOW_FAILED" << std::endl;
+                glfwTerminate();
+                return false;
+            }
+            glfwMakeContextCurrent(window);
+            // GLFW callbacks are plain functions; find the platform through the window
+            glfwSetWindowUserPointer(window, this);
+            glfwSetFramebufferSizeCallback(window, [](GLFWwindow* window, int width, int height) {
+                GlfwPlatform* platform = (GlfwPlatform*)glfwGetWindowUserPointer(window);
+                if (platform->resizeCallback)
+                    platform->resizeCallback(width, height);
+            });
+            glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int, int action, int) {
+                GlfwPlatform* platform = (GlfwPlatform*)glfwGetWindowUserPointer(window);
+                if (action == GLFW_PRESS && platform->keyCallback)
+                    platform->keyCallback(key);
+            });
+            return true;
+        }
+
+        std::unique_ptr<SharedContext> createSharedContext() override
+        {
+            setContextHints();
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            GLFWwindow* shared = glfwCreateWindow(1, 1, "", NULL, window);
+            if (shared == NULL)
+            {
+                std::cout << "ERROR::PLATFORM::GLFW_SHARED_CONTEXT_FAILED" << std::endl;
+                return nullptr;
+            }
+            return std::unique_ptr<SharedContext>(new GlfwSharedContext(shared));
+        }
+
+        void destroy() override
+        {
+            if (!window)
+                return;
+            glfwTerminate();
+            window = NULL;
+        }
+
+        void makeCurrent(bool current) override
+        {
+            glfwMakeContextCurrent(current ? window : NULL);
+        }
+
+        void* procAddress(const char* name) override
+        {
+            return (void*)glfwGetProcAddress(name);
+        }
+
+        void framebufferSize(int& width, int& height) override
+        {
+            glfwGetFramebufferSize(window, &width, &height);
+        }
+
+        double time() override
+        {
+            return glfwGetTime();
+        }
+
+        bool shouldClose() override
+        {
+            return glfwWindowShouldClose(window);
+        }
+
+        void requestClose() override
+        {
+            glfwSetWindowShouldClose(window, true);
+        }
+
+        bool keyDown(int key) override
+        {
+            return glfwGetKey(window, key) == GLFW_PRESS;
+        }
+
+        void pollEvents() override
+        {
+            glfwPollEvents();
+        }
+
+        void swapBuffers() override
+        {
+            glfwSwapBuffers(window);
+        }
+
+        void setTitle(const char* title) override
+        {
+            glfwSetWindowTitle(window, title);
+        }
+
+    private:
+        static void setContextHints()
+        {
+            glfwDefaultWindowHints();
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        }
+
+        GLFWwindow* window = NULL;
+    };
+}
+
+std::unique_ptr<Platform> createGlfwPlatform()
+{
+    return std::unique_ptr<Platform>(new GlfwPlatform());
+}
@@ -0,0 +1,138 @@
+#include "platform.h"
+
+#include <GL/osmesa.h>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const int CONTEXT_ATTRIBS[] = {
+        OSMESA_FORMAT, OSMESA_RGBA,
+        OSMESA_DEPTH_BITS, 24,
+        OSMESA_STENCIL_BITS, 8,
+        OSMESA_PROFILE, OSMESA_CORE_PROFILE,
+        OSMESA_CONTEXT_MAJOR_VERSION, 3,
+        OSMESA_CONTEXT_MINOR_VERSION, 3,
+        0
+    };
+
+    // OSMesa needs a buffer to make a context current; a background context never draws
+    // to it, so one pixel does
+    class OsMesaSharedContext : public SharedContext
+    {
+    public:
+        explicit OsMesaSharedContext(OSMesaContext context) : context(context) {}
+        ~OsMesaSharedContext() override { OSMesaDestroyContext(context); }
+
+        bool makeCurrent(bool current) override
+        {
+            if (current)
+                return OSMesaMakeCurrent(context, pixel, GL_UNSIGNED_BYTE, 1, 1);
+            return OSMesaMakeCurrent(NULL, NULL, GL_UNSIGNED_BYTE, 0, 0);
+        }
+
+    private:
+        OSMesaContext context;
+        unsigned char pixel[4] = {};
+    };
+
+    // Mesa's off-screen context, rendered in software by llvmpipe. OSMesa draws into a
+    // buffer we own; the renderer only uses its framebuffer objects, so that buffer is
+    // never read. Nothing to swap or poll.
+    class OsMesaPlatform : public Platform
+    {
+    public:
+        bool init(int width, int height, bool visible, const char*) override
+        {
+            if (visible)
+            {
+                std::cout << "ERROR::PLATFORM::OSMESA_HAS_NO_WINDOW" << std::endl;
+                return false;
+            }
+            this->width = width;
+            this->height = height;
+
+            context = OSMesaCreateContextAttribs(CONTEXT_ATTRIBS, NULL);
+            if (!context)
+            {
+                std::cout << "ERROR::PLATFORM::OSMESA_CONTEXT_FAILED (needs Mesa built with a core profile capable driver)" << std::endl;
+                return false;
+            }
+            buffer.resize((size_t)width * height * 4);
+            if (!OSMesaMakeCurrent(context, buffer.data(), GL_UNSIGNED_BYTE, width, height))
+            {
+                std::cout << "ERROR::PLATFORM::OSMESA_MAKE_CURRENT_FAILED" << std::endl;
+                destroy();
+                return false;
+            }
+            start = std::chrono::steady_clock::now();
+            return true;
+        }
+
+        std::unique_ptr<SharedContext> createSharedContext() override
+        {
+            OSMesaContext shared = OSMesaCreateContextAttribs(CONTEXT_ATTRIBS, context);
+            if (!shared)
+            {
+                std::cout << "ERROR::PLATFORM::OSMESA_SHARED_CONTEXT_FAILED" << std::endl;
+                return nullptr;
+            }
+            return std::unique_ptr<SharedContext>(new OsMesaSharedContext(shared));
+        }
+
+        void destroy() override
+        {
+            if (!context)
+                return;
+            OSMesaMakeCurrent(NULL, NULL, GL_UNSIGNED_BYTE, 0, 0);
+            OSMesaDestroyContext(context);
+            context = NULL;
+        }
+
+        void makeCurrent(bool current) override
+        {
+            if (current)
+                OSMesaMakeCurrent(context, buffer.data(), GL_UNSIGNED_BYTE, width, height);
+            else
+                OSMesaMakeCurrent(NULL, NULL, GL_UNSIGNED_BYTE, 0, 0);
+        }
+
+        void* procAddress(const char* name) override
+        {
+            return (void*)OSMesaGetProcAddress(name);
+        }
+
+        void framebufferSize(int& width, int& height) override
+        {
+            width = this->width;
+            height = this->height;
+        }
+
+        double time() override
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        bool shouldClose() override { return closeRequested; }
+        void requestClose() override { closeRequested = true; }
+        bool keyDown(int) override { return false; }
+        void pollEvents() override {}
+        void swapBuffers() override {}
+        void setTitle(const char*) override {}
+
+    private:
+        OSMesaContext context = NULL;
+        std::vector<unsigned char> buffer;
+        int width = 0;
+        int height = 0;
+        bool closeRequested = false;
+        std::chrono::steady_clock::time_point start;
+    };
+}
+
+std::unique_ptr<Platform> createOsMesaPlatform()
+{
+    return std::unique_ptr<Platform>(new OsMesaPlatform());
+}
@@ -0,0 +1,183 @@
+#include "program_cache.h"
+#include "shader.h"
+#include "timing.h"
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const uint32_t CACHE_MAGIC = 0x42505056;    // "VPPB"
+    const uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    // 64-bit FNV-1a, chained across several strings
+    uint64_t fnv1a(const std::string& text, uint64_t hash)
+    {
+        for (unsigned char c : text)
+        {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        // Separator so ("ab", "c") and ("a", "bc") hash differently
+        hash ^= 0xff;
+        hash *= 1099511628211ull;
+        return hash;
+    }
+
+    std::string glString(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value ? (const char*)value : "";
+    }
+}
+
+bool ProgramCache::init(const std::string& cacheDirectory)
+{
+    directory = cacheDirectory;
+    driverId = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+
+    int formats = 0;
+    if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    supported = formats > 0;
+    if (!supported)
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error)
+    {
+        std::cout << "ERROR::PROGRAM_CACHE::CANNOT_CREATE " << directory << std::endl;
+        supported = false;
+    }
+    return supported;
+}
+
+uint64_t ProgramCache::key(const char* vertexSource, const char* fragmentSource,
+                           const std::vector<std::string>& defines) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    hash = fnv1a(vertexSource, hash);
+    hash = fnv1a(fragmentSource, hash);
+    for (const std::string& define : defines)
+        hash = fnv1a(define, hash);
+    return fnv1a(driverId, hash);
+}
+
+std::string ProgramCache::pathFor(uint64_t hash) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)hash);
+    return (std::filesystem::path(directory) / name).string();
+}
+
+unsigned int ProgramCache::loadBinary(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return 0;
+
+    CacheHeader header = {};
+    file.read((char*)&header, sizeof(header));
+    if (!file || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.length == 0)
+        return 0;
+
+    std::vector<char> binary(header.length);
+    file.read(binary.data(), (std::streamsize)binary.size());
+    if (!file)
+        return 0;
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, (GLenum)header.format, binary.data(), (GLsizei)binary.size());
+
+    // The driver rejects binaries it can no longer use, which counts as stale
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(program);
+        ++counters.stale;
+        return 0;
+    }
+    return program;
+}
+
+void ProgramCache::storeBinary(const std::string& path, unsigned int program)
+{
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, NULL, &format, binary.data());
+
+    // Write to a temporary file first so a crash never leaves a truncated entry. Processes
+    // sharing the cache directory (--batch-processes) each write their own.
+    std::string temporary = path + "." + std::to_string(getpid()) + ".tmp";
+    std::error_code error;
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, (uint32_t)format, (uint32_t)length };
+        file.write((const char*)&header, sizeof(header));
+        file.write(binary.data(), length);
+        file.close();
+        if (!file)
+        {
+            std::cout << "ERROR::PROGRAM_CACHE::CANNOT_WRITE " << temporary << std::endl;
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error)
+        std::filesystem::remove(temporary, error);
+}
+
+unsigned int ProgramCache::getProgram(const char* vertexSource, const char* fragmentSource,
+                                      const std::vector<std::string>& defines)
+{
+    std::string path;
+    if (supported)
+    {
+        auto loadStart = std::chrono::steady_clock::now();
+        path = pathFor(key(vertexSource, fragmentSource, defines));
+        unsigned int program = loadBinary(path);
+        if (program)
+        {
+            ++counters.hits;
+            counters.loadMs += millisecondsSince(loadStart);
+            return program;
+        }
+    }
+
+    auto compileStart = std::chrono::steady_clock::now();
+    unsigned int program = compileProgram(vertexSource, fragmentSource, defines, supported);
+    ++counters.misses;
+    counters.compileMs += millisecondsSince(compileStart);
+
+    if (program && supported)
+        storeBinary(path, program);
+    return program;
+}
@@ -0,0 +1,48 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counters for one run, split so cold (compile) and warm (binary load) costs can be compared
+struct ProgramCacheStats
+{
+    int hits = 0;
+    int misses = 0;         // not on disk, or rejected by the driver
+    int stale = 0;          // subset of misses where a cached binary was rejected
+    double loadMs = 0.0;    // time spent in glProgramBinary for hits
+    double compileMs = 0.0; // time spent compiling and linking for misses
+};
+
+// Stores linked program binaries on disk so later launches skip compilation.
+// Entries are keyed by a hash of the shader sources, defines and the driver's
+// vendor/renderer/version strings, so a driver update simply misses the cache.
+class ProgramCache
+{
+public:
+    // Returns false when the driver exposes no program binary formats; the cache then
+    // just compiles every program.
+    bool init(const std::string& directory);
+
+    // Load a program from the cache, or compile it and store the result
+    unsigned int getProgram(const char* vertexSource, const char* fragmentSource,
+                            const std::vector<std::string>& defines);
+
+    bool enabled() const { return supported; }
+    const ProgramCacheStats& stats() const { return counters; }
+
+private:
+    uint64_t key(const char* vertexSource, const char* fragmentSource,
+                 const std::vector<std::string>& defines) const;
+    std::string pathFor(uint64_t hash) const;
+    unsigned int loadBinary(const std::string& path);
+    void storeBinary(const std::string& path, unsigned int program);
+
+    std::string directory;
+    std::string driverId;
+    bool supported = false;
+    ProgramCacheStats counters;
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "readback_ring.h"
+#include "gl_state.h"
+#include "timing.h"
+#include "trace.h"
+
+#include <iostream>
+#include <vector>
+
+bool ReadbackRing::init(int readWidth, int readHeight)
+{
+    width = readWidth;
+    height = readHeight;
+    const size_t bytes = (size_t)width * (size_t)height * 4;
+    GlState& state = glState();
+    for (Slot& slot : slots)
+    {
+        glGenBuffers(1, &slot.buffer);
+        state.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)bytes, NULL, GL_STREAM_READ);
+    }
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void ReadbackRing::destroy()
+{
+    for (Slot& slot : slots)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        if (slot.buffer)
+            glDeleteBuffers(1, &slot.buffer);
+        slot = Slot();
+    }
+}
+
+void ReadbackRing::read(unsigned int fbo, int frame, const ReadbackHandler& handler)
+{
+    // The slot this read needs is the oldest in flight; if the GPU is still writing it, wait
+    for (int i = 0; i < BUFFERS; ++i)
+    {
+        Slot& slot = slots[(next + i) % BUFFERS];
+        if (slot.fence && !retire(slot, false, handler))
+            break;
+    }
+    Slot& slot = slots[next];
+    if (slot.fence)
+        retire(slot, true, handler);
+
+    // With a pack buffer bound, glReadPixels only queues the copy and returns
+    GlState& state = glState();
+    state.bindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+    // Unbind so readbacks into client memory elsewhere are not redirected into the buffer
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.frame = frame;
+    slot.issued = std::chrono::steady_clock::now();
+    next = (next + 1) % BUFFERS;
+    ++counters.reads;
+}
+
+void ReadbackRing::drain(const ReadbackHandler& handler)
+{
+    for (int i = 0; i < BUFFERS; ++i)
+    {
+        Slot& slot = slots[(next + i) % BUFFERS];
+        if (slot.fence)
+            retire(slot, true, handler);
+    }
+}
+
+bool ReadbackRing::retire(Slot& slot, bool wait, const ReadbackHandler& handler)
+{
+    GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        if (!wait)
+            return false;
+        TRACE_SCOPE("readback wait");
+        auto waitStart = std::chrono::steady_clock::now();
+        do
+        {
+            status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        ++counters.fenceWaits;
+        counters.waitMs += millisecondsSince(waitStart);
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    TRACE_SCOPE("readback map");
+    auto mapStart = std::chrono::steady_clock::now();
+    GlState& state = glState();
+    const size_t bytes = (size_t)width * (size_t)height * 4;
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const uint8_t* pixels = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)bytes, GL_MAP_READ_BIT);
+    if (pixels)
+    {
+        handler(Readback{ slot.frame, pixels, slot.issued });
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    else
+    {
+        // Hand over a black frame so numbering downstream stays in step
+        std::cout << "ERROR::READBACK::MAP_FAILED frame " << slot.frame << std::endl;
+        std::vector<uint8_t> black(bytes, 0);
+        handler(Readback{ slot.frame, black.data(), slot.issued });
+    }
+    state.bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    counters.handlerMs += millisecondsSince(mapStart);
+    return true;
+}
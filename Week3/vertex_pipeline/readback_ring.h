@@ -0,0 +1,72 @@
+#ifndef READBACK_RING_H
+#define READBACK_RING_H
+
+#include <glad/glad.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// One finished readback. pixels is tightly packed RGBA with the bottom row first, as GL
+// returns it, and is only valid during the handler call.
+struct Readback
+{
+    int frame;
+    const uint8_t* pixels;
+    std::chrono::steady_clock::time_point issued;  // when the frame was read back
+};
+
+using ReadbackHandler = std::function<void(const Readback&)>;
+
+struct ReadbackStats
+{
+    uint64_t reads = 0;
+    uint64_t fenceWaits = 0;        // reads that waited for the GPU to finish an older one
+    double waitMs = 0.0;            // total time spent in those waits
+    double handlerMs = 0.0;         // total time mapping readbacks and running the handler
+};
+
+// Reads a color buffer back without stalling. Each read goes into the next of a ring of
+// pixel pack buffers and is fenced, so glReadPixels only queues the copy; a readback is
+// mapped and handed over a few frames later, once its fence has signaled. Only when the GPU
+// is a whole ring behind does read() wait for the oldest one.
+class ReadbackRing
+{
+public:
+    static const int BUFFERS = 3;
+
+    bool init(int width, int height);
+    void destroy();
+
+    bool active() const { return slots[0].buffer != 0; }
+    int readWidth() const { return width; }
+    int readHeight() const { return height; }
+
+    // Hand every finished readback to handler, oldest first, then queue a read of the color
+    // attachment of fbo. The framebuffer must be width x height.
+    void read(unsigned int fbo, int frame, const ReadbackHandler& handler);
+
+    // Wait for every readback in flight and hand them all to handler
+    void drain(const ReadbackHandler& handler);
+
+    const ReadbackStats& stats() const { return counters; }
+
+private:
+    struct Slot
+    {
+        unsigned int buffer = 0;
+        GLsync fence = nullptr;
+        int frame = -1;
+        std::chrono::steady_clock::time_point issued;
+    };
+
+    bool retire(Slot& slot, bool wait, const ReadbackHandler& handler);
+
+    int width = 0;
+    int height = 0;
+    Slot slots[BUFFERS];
+    int next = 0;
+    ReadbackStats counters;
+};
+
+#endif
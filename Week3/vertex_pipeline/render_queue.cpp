@@ -0,0 +1,93 @@
+#include "render_queue.h"
+
+#include <algorithm>
+
+uint64_t makeSortKey(uint32_t pass, uint32_t program, uint32_t vertexArray, uint32_t material, uint32_t depth)
+{
+    return (uint64_t)std::min(pass, SORT_KEY_MAX_PASS) << SORT_KEY_PASS_SHIFT |
+           (uint64_t)std::min(program, SORT_KEY_MAX_PROGRAM) << SORT_KEY_PROGRAM_SHIFT |
+           (uint64_t)std::min(vertexArray, SORT_KEY_MAX_VERTEX_ARRAY) << SORT_KEY_VERTEX_ARRAY_SHIFT |
+           (uint64_t)std::min(material, SORT_KEY_MAX_MATERIAL) << SORT_KEY_MATERIAL_SHIFT |
+           (uint64_t)std::min(depth, SORT_KEY_MAX_DEPTH);
+}
+
+uint32_t quantizeDepth(float distance, float nearPlane, float farPlane, bool farthestFirst)
+{
+    float t = (distance - nearPlane) / (farPlane - nearPlane);
+    t = std::min(std::max(t, 0.0f), 1.0f);
+    if (farthestFirst)
+        t = 1.0f - t;
+    return (uint32_t)(t * (float)SORT_KEY_MAX_DEPTH);
+}
+
+void RenderQueue::reserve(size_t count)
+{
+    items.reserve(count);
+    scratch.reserve(count);
+}
+
+void RenderQueue::sort()
+{
+    sortPasses = 0;
+    const size_t count = items.size();
+
+    // Short queues are cheaper to sort in place than to build eight histograms for
+    const size_t INSERTION_SORT_LIMIT = 64;
+    if (count <= INSERTION_SORT_LIMIT)
+    {
+        for (size_t i = 1; i < count; ++i)
+        {
+            DrawItem item = items[i];
+            size_t j = i;
+            for (; j > 0 && items[j - 1].key > item.key; --j)
+                items[j] = items[j - 1];
+            items[j] = item;
+        }
+        return;
+    }
+
+    // One read of the keys fills the histograms of all eight bytes
+    uint32_t histograms[8][256] = {};
+    for (const DrawItem& item : items)
+    {
+        uint64_t key = item.key;
+        for (int byte = 0; byte < 8; ++byte)
+            ++histograms[byte][(key >> (byte * 8)) & 0xFF];
+    }
+
+    scratch.resize(count);
+    for (int byte = 0; byte < 8; ++byte)
+    {
+        uint32_t* histogram = histograms[byte];
+        const uint32_t firstDigit = (uint32_t)(items[0].key >> (byte * 8)) & 0xFF;
+        if (histogram[firstDigit] == count)
+            continue;
+
+        // Counts become each digit's first output slot
+        uint32_t offset = 0;
+        for (int digit = 0; digit < 256; ++digit)
+        {
+            uint32_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (const DrawItem& item : items)
+            scratch[histogram[(item.key >> (byte * 8)) & 0xFF]++] = item;
+        items.swap(scratch);
+        ++sortPasses;
+    }
+}
+
+size_t countStateChanges(const RenderQueue& queue)
+{
+    size_t changes = 0;
+    uint64_t previous = 0;
+    for (size_t i = 0; i < queue.size(); ++i)
+    {
+        if (i == 0 || ((queue[i].key ^ previous) & SORT_KEY_STATE_MASK) != 0)
+            ++changes;
+        previous = queue[i].key;
+    }
+    return changes;
+}
@@ -0,0 +1,82 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A draw is recorded as one 64-bit key plus a payload index. The fields are packed most
+// significant first, so sorting the keys groups draws by pass, then program, then vertex
+// array, then material, and orders every group front to back:
+//
+//   63..60 pass | 59..50 program | 49..40 vertex array | 39..24 material | 23..0 depth
+//
+// Programs, vertex arrays and materials are small ids chosen by the caller, not GL names.
+const int SORT_KEY_PASS_SHIFT = 60;
+const int SORT_KEY_PROGRAM_SHIFT = 50;
+const int SORT_KEY_VERTEX_ARRAY_SHIFT = 40;
+const int SORT_KEY_MATERIAL_SHIFT = 24;
+const uint32_t SORT_KEY_MAX_PASS = 0xF;
+const uint32_t SORT_KEY_MAX_PROGRAM = 0x3FF;
+const uint32_t SORT_KEY_MAX_VERTEX_ARRAY = 0x3FF;
+const uint32_t SORT_KEY_MAX_MATERIAL = 0xFFFF;
+const uint32_t SORT_KEY_MAX_DEPTH = 0xFFFFFF;
+
+// Everything but the depth: consecutive draws whose keys differ here need a state change
+const uint64_t SORT_KEY_STATE_MASK = ~(uint64_t)SORT_KEY_MAX_DEPTH;
+
+enum RenderPass {
+    PASS_OPAQUE = 0,
+    PASS_TRANSPARENT = 1
+};
+
+// Out of range ids are clamped to the largest value their field holds
+uint64_t makeSortKey(uint32_t pass, uint32_t program, uint32_t vertexArray, uint32_t material, uint32_t depth);
+
+inline uint32_t sortKeyPass(uint64_t key) { return (uint32_t)(key >> SORT_KEY_PASS_SHIFT) & SORT_KEY_MAX_PASS; }
+inline uint32_t sortKeyProgram(uint64_t key) { return (uint32_t)(key >> SORT_KEY_PROGRAM_SHIFT) & SORT_KEY_MAX_PROGRAM; }
+inline uint32_t sortKeyVertexArray(uint64_t key) { return (uint32_t)(key >> SORT_KEY_VERTEX_ARRAY_SHIFT) & SORT_KEY_MAX_VERTEX_ARRAY; }
+inline uint32_t sortKeyMaterial(uint64_t key) { return (uint32_t)(key >> SORT_KEY_MATERIAL_SHIFT) & SORT_KEY_MAX_MATERIAL; }
+
+// Map a view distance between the clip planes onto the depth field, nearest first.
+// Transparent passes want back to front and pass farthestFirst = true.
+uint32_t quantizeDepth(float distance, float nearPlane, float farPlane, bool farthestFirst = false);
+
+struct DrawItem
+{
+    uint64_t key;
+    uint32_t payload;   // caller's index of whatever the draw needs (object, mesh, ...)
+};
+
+// Per-frame draw list. Fill it, sort() it, then walk it in order and change state only
+// where the key's state bits change.
+class RenderQueue
+{
+public:
+    void reserve(size_t count);
+    void clear() { items.clear(); }
+    void push(uint64_t key, uint32_t payload) { items.push_back(DrawItem{ key, payload }); }
+
+    // Stable LSD radix sort on the keys, one byte per pass. Bytes that are the same in
+    // every key (usually the pass and program) are skipped. Short queues use insertion sort.
+    void sort();
+
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+    const DrawItem& operator[](size_t i) const { return items[i]; }
+    std::vector<DrawItem>::const_iterator begin() const { return items.begin(); }
+    std::vector<DrawItem>::const_iterator end() const { return items.end(); }
+
+    // Byte passes the last sort() actually ran (0 to 8; 0 after an insertion sort)
+    int lastSortPasses() const { return sortPasses; }
+
+private:
+    std::vector<DrawItem> items;
+    std::vector<DrawItem> scratch;
+    int sortPasses = 0;
+};
+
+// Number of draws whose state bits differ from the draw before (the first draw counts)
+size_t countStateChanges(const RenderQueue& queue);
+
+#endif
@@ -0,0 +1,120 @@
+#include "render_target.h"
+
+#include "gl_state.h"
+
+#include <iostream>
+
+bool createRenderTarget(RenderTarget& target, int width, int height, const RenderTargetFormat& format)
+{
+    target.width = width;
+    target.height = height;
+    target.storageWidth = width;
+    target.storageHeight = height;
+    target.format = format;
+
+    glGenFramebuffers(1, &target.fbo);
+    glState().bindFramebuffer(GL_FRAMEBUFFER, target.fbo);
+
+    glGenRenderbuffers(1, &target.colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, format.color, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colorBuffer);
+
+    glGenRenderbuffers(1, &target.depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, format.depth, width, height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.depthBuffer);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glState().bindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (!complete)
+    {
+        std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE" << std::endl;
+        destroyRenderTarget(target);
+        return false;
+    }
+    return true;
+}
+
+void destroyRenderTarget(RenderTarget& target)
+{
+    glDeleteRenderbuffers(1, &target.colorBuffer);
+    glDeleteRenderbuffers(1, &target.depthBuffer);
+    glDeleteFramebuffers(1, &target.fbo);
+    target = RenderTarget();
+
+    // A deleted framebuffer that was bound reverts to 0 and its name may come back for the
+    // next one, so the cached bindings can no longer be trusted
+    glState().invalidate();
+}
+
+static int roundUpToStep(int size)
+{
+    return (size + RenderTargetPool::SIZE_STEP - 1) / RenderTargetPool::SIZE_STEP * RenderTargetPool::SIZE_STEP;
+}
+
+RenderTarget* RenderTargetPool::acquire(int width, int height, const RenderTargetFormat& format)
+{
+    const int storageWidth = roundUpToStep(width);
+    const int storageHeight = roundUpToStep(height);
+    for (Entry& entry : entries)
+    {
+        RenderTarget& target = *entry.target;
+        if (entry.inUse || !(target.format == format) ||
+            target.storageWidth != storageWidth || target.storageHeight != storageHeight)
+            continue;
+        entry.inUse = true;
+        entry.idleFrames = 0;
+        target.width = width;
+        target.height = height;
+        ++reuseCount;
+        return &target;
+    }
+
+    Entry entry;
+    entry.target.reset(new RenderTarget());
+    if (!createRenderTarget(*entry.target, storageWidth, storageHeight, format))
+        return nullptr;
+    entry.target->width = width;
+    entry.target->height = height;
+    entry.inUse = true;
+    entries.push_back(std::move(entry));
+    ++allocationCount;
+    return entries.back().target.get();
+}
+
+void RenderTargetPool::release(RenderTarget* target)
+{
+    for (Entry& entry : entries)
+    {
+        if (entry.target.get() == target)
+        {
+            entry.inUse = false;
+            entry.idleFrames = 0;
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::endFrame()
+{
+    for (size_t i = 0; i < entries.size();)
+    {
+        Entry& entry = entries[i];
+        if (!entry.inUse && ++entry.idleFrames > MAX_IDLE_FRAMES)
+        {
+            destroyRenderTarget(*entry.target);
+            entries.erase(entries.begin() + (long)i);
+            continue;
+        }
+        ++i;
+    }
+}
+
+void RenderTargetPool::destroy()
+{
+    for (Entry& entry : entries)
+        destroyRenderTarget(*entry.target);
+    entries.clear();
+}
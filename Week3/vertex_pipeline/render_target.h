@@ -0,0 +1,69 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <glad/glad.h>
+
+#include <memory>
+#include <vector>
+
+// Internal formats of a render target's attachments
+struct RenderTargetFormat
+{
+    GLenum color = GL_RGBA8;
+    GLenum depth = GL_DEPTH24_STENCIL8;
+
+    bool operator==(const RenderTargetFormat& other) const { return color == other.color && depth == other.depth; }
+};
+
+// Framebuffer object with a color and a depth renderbuffer. width/height is the area in
+// use; the storage may be larger (storageWidth/storageHeight) when it comes from a pool.
+struct RenderTarget
+{
+    unsigned int fbo = 0;
+    unsigned int colorBuffer = 0;
+    unsigned int depthBuffer = 0;
+    int width = 0;
+    int height = 0;
+    int storageWidth = 0;
+    int storageHeight = 0;
+    RenderTargetFormat format;
+};
+
+bool createRenderTarget(RenderTarget& target, int width, int height, const RenderTargetFormat& format = RenderTargetFormat());
+void destroyRenderTarget(RenderTarget& target);
+
+// Keeps released render targets around for reuse by size and format. Storage is rounded
+// up to SIZE_STEP, so a window being dragged keeps reusing one target for a range of sizes
+// instead of reallocating every frame. Targets left idle for MAX_IDLE_FRAMES are freed.
+class RenderTargetPool
+{
+public:
+    static const int SIZE_STEP = 128;
+    static const int MAX_IDLE_FRAMES = 120;
+
+    // Returns nullptr if the framebuffer cannot be created. The pointer stays valid until
+    // the target is released and then freed, or the pool is destroyed.
+    RenderTarget* acquire(int width, int height, const RenderTargetFormat& format = RenderTargetFormat());
+    void release(RenderTarget* target);
+
+    // Age idle targets; call once per frame
+    void endFrame();
+    void destroy();
+
+    int allocations() const { return allocationCount; }
+    int reuses() const { return reuseCount; }
+
+private:
+    struct Entry
+    {
+        std::unique_ptr<RenderTarget> target;
+        bool inUse = false;
+        int idleFrames = 0;
+    };
+
+    std::vector<Entry> entries;
+    int allocationCount = 0;
+    int reuseCount = 0;
+};
+
+#endif
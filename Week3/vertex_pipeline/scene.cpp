@@ -0,0 +1,89 @@
+#include "scene.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+std::vector<glm::vec3> buildGridPositions(int count, float spacing, float& extent)
+{
+    int side = 1;
+    while (side * side * side < count)
+        ++side;
+
+    std::vector<glm::vec3> positions;
+    positions.reserve(count);
+    float offset = (float)(side - 1) * 0.5f;
+    for (int i = 0; i < count; ++i)
+    {
+        int x = i % side;
+        int y = (i / side) % side;
+        int z = i / (side * side);
+        positions.push_back(glm::vec3((float)x - offset, (float)y - offset, -(float)z) * spacing);
+    }
+    extent = offset * spacing;
+    return positions;
+}
+
+SceneLayout buildScene(int objects)
+{
+    // Pull the camera back far enough that the front of the grid fits the 45 degree field of view
+    SceneLayout scene;
+    float gridExtent = 0.0f;
+    scene.positions = buildGridPositions(objects, 1.5f, gridExtent);
+    scene.viewDistance = 3.0f + gridExtent * 2.7f;
+    return scene;
+}
+
+glm::mat4 sceneView(const SceneLayout& scene)
+{
+    glm::mat4 view = glm::mat4(1.0f);
+    return glm::translate(view, glm::vec3(0.0f, 0.0f, -scene.viewDistance));
+}
+
+float sceneFarPlane(const SceneLayout& scene)
+{
+    return 100.0f + scene.viewDistance * 2.0f;
+}
+
+glm::mat4 sceneProjection(const SceneLayout& scene, int width, int height)
+{
+    return glm::perspective(glm::radians(45.0f), (float)width / (float)height, SCENE_NEAR_PLANE, sceneFarPlane(scene));
+}
+
+glm::mat4 objectRotation(float time)
+{
+    return glm::rotate(glm::mat4(1.0f), time, glm::vec3(0.5f, 1.0f, 0.0f));
+}
+
+glm::mat4 objectModel(const glm::vec3& position, float time)
+{
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, position);
+    return glm::rotate(model, time, glm::vec3(0.5f, 1.0f, 0.0f));
+}
+
+glm::vec3 spaceColor(int space)
+{
+    switch (space) {
+        case MODEL_SPACE:
+            return glm::vec3(1.0f, 0.0f, 0.0f);
+        case WORLD_SPACE:
+            return glm::vec3(0.0f, 1.0f, 0.0f);
+        case VIEW_SPACE:
+            return glm::vec3(0.0f, 0.0f, 1.0f);
+        default:
+            return glm::vec3(1.0f, 1.0f, 0.0f);
+    }
+}
+
+const char* spaceName(int space)
+{
+    switch (space) {
+        case MODEL_SPACE:
+            return "MODEL SPACE";
+        case WORLD_SPACE:
+            return "WORLD SPACE";
+        case VIEW_SPACE:
+            return "VIEW SPACE";
+        default:
+            return "CLIP SPACE";
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Define the different coordinate spaces as integers for coloring
+enum CoordinateSpace {
+    MODEL_SPACE = 0,
+    WORLD_SPACE = 1,
+    VIEW_SPACE = 2,
+    CLIP_SPACE = 3
+};
+
+// The grid of objects every render path draws, and the camera distance that frames it
+struct SceneLayout
+{
+    std::vector<glm::vec3> positions;
+    float viewDistance = 3.0f;
+};
+
+// Place count objects on a centered grid, filling x and y before z.
+// extent receives the half-size of the grid so the camera can frame it.
+std::vector<glm::vec3> buildGridPositions(int count, float spacing, float& extent);
+SceneLayout buildScene(int objects);
+
+// Clip planes of the scene camera; the far plane moves out with the grid
+const float SCENE_NEAR_PLANE = 0.1f;
+float sceneFarPlane(const SceneLayout& scene);
+
+glm::mat4 sceneView(const SceneLayout& scene);
+glm::mat4 sceneProjection(const SceneLayout& scene, int width, int height);
+
+// Spin shared by every object, and the full model matrix of one object
+glm::mat4 objectRotation(float time);
+glm::mat4 objectModel(const glm::vec3& position, float time);
+
+// Display name of each coordinate space, e.g. "MODEL SPACE"
+const char* spaceName(int space);
+
+// Flat color of each coordinate space; must match the SPACE_COLOR shader defines
+glm::vec3 spaceColor(int space);
+
+#endif
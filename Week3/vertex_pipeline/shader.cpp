@@ -0,0 +1,214 @@
+#include "shader.h"
+#include "program_cache.h"
+
+#include <glad/glad.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+static unsigned int compileStage(GLenum stage, const char* source, const char* stageName)
+{
+    unsigned int shader = glCreateShader(stage);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    // Check for shader compile errors
+    int success;
+    char infoLog[512];
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(shader, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::" << stageName << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+bool loadShaderFile(const std::string& path, std::string& source)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::SHADER::FILE_NOT_READ " << path << std::endl;
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    source = text.str();
+    return true;
+}
+
+std::string injectDefines(const char* source, const std::vector<std::string>& defines)
+{
+    std::string text(source);
+    if (defines.empty())
+        return text;
+
+    std::string block;
+    for (const std::string& define : defines)
+        block += "#define " + define + "\n";
+
+    // #version has to stay the first directive, so the defines go on the line after it
+    size_t version = text.find("#version");
+    size_t insertAt = version == std::string::npos ? 0 : text.find('\n', version);
+    insertAt = insertAt == std::string::npos ? text.size() : insertAt + 1;
+    text.insert(insertAt, block);
+    return text;
+}
+
+unsigned int compileProgram(const char* vertexSource, const char* fragmentSource,
+                            const std::vector<std::string>& defines, bool retrievable)
+{
+    std::string vertexText = injectDefines(vertexSource, defines);
+    std::string fragmentText = injectDefines(fragmentSource, defines);
+    unsigned int vertexShader = compileStage(GL_VERTEX_SHADER, vertexText.c_str(), "VERTEX");
+    unsigned int fragmentShader = compileStage(GL_FRAGMENT_SHADER, fragmentText.c_str(), "FRAGMENT");
+    if (!vertexShader || !fragmentShader)
+    {
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+
+    // Link shaders
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    if (retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    // Check for linking errors
+    int success;
+    char infoLog[512];
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(program, 512, NULL, infoLog);
+        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+int ShaderReflection::location(const std::string& name) const
+{
+    auto it = uniforms.find(name);
+    return it == uniforms.end() ? -1 : it->second.location;
+}
+
+ShaderReflection reflectProgram(unsigned int program)
+{
+    ShaderReflection reflection;
+
+    int uniformCount = 0, maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    std::vector<char> name(maxNameLength > 0 ? maxNameLength : 1);
+
+    for (int i = 0; i < uniformCount; ++i)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(program, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+        GLuint index = (GLuint)i;
+        UniformInfo info;
+        info.type = type;
+        info.size = size;
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &info.blockIndex);
+        glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &info.offset);
+        if (info.blockIndex < 0)
+            info.location = glGetUniformLocation(program, name.data());
+
+        // Arrays are reported as "name[0]"; store them under the plain name too
+        std::string uniformName(name.data(), length);
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            reflection.uniforms[uniformName.substr(0, uniformName.size() - 3)] = info;
+        reflection.uniforms[uniformName] = info;
+    }
+
+    int blockCount = 0, maxBlockNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+    std::vector<char> blockName(maxBlockNameLength > 0 ? maxBlockNameLength : 1);
+
+    for (int i = 0; i < blockCount; ++i)
+    {
+        GLsizei length = 0;
+        glGetActiveUniformBlockName(program, (GLuint)i, (GLsizei)blockName.size(), &length, blockName.data());
+
+        UniformBlockInfo info;
+        info.index = (unsigned int)i;
+        glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_DATA_SIZE, &info.dataSize);
+        glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_BINDING, &info.binding);
+        reflection.blocks[std::string(blockName.data(), length)] = info;
+    }
+
+    return reflection;
+}
+
+bool bindUniformBlock(unsigned int program, ShaderReflection& reflection, const std::string& name, int binding)
+{
+    auto it = reflection.blocks.find(name);
+    if (it == reflection.blocks.end())
+        return false;
+    glUniformBlockBinding(program, it->second.index, (GLuint)binding);
+    it->second.binding = binding;
+    return true;
+}
+
+bool ShaderVariants::build(const char* vertexSource, const char* fragmentSource,
+                           const std::vector<std::vector<std::string>>& defineSets, ProgramCache* cache)
+{
+    destroy();
+    for (const std::vector<std::string>& defines : defineSets)
+    {
+        ShaderVariant variant;
+        variant.defines = defines;
+        variant.program = cache ? cache->getProgram(vertexSource, fragmentSource, defines)
+                                : compileProgram(vertexSource, fragmentSource, defines);
+        if (!variant.program)
+        {
+            destroy();
+            return false;
+        }
+        variant.reflection = reflectProgram(variant.program);
+        variants.push_back(variant);
+    }
+    return true;
+}
+
+void ShaderVariants::destroy()
+{
+    for (ShaderVariant& variant : variants)
+        glDeleteProgram(variant.program);
+    variants.clear();
+    blockBindings.clear();
+}
+
+void ShaderVariants::bindUniformBlock(const std::string& name, int binding)
+{
+    for (ShaderVariant& variant : variants)
+        ::bindUniformBlock(variant.program, variant.reflection, name, binding);
+    blockBindings.push_back(std::make_pair(name, binding));
+}
+
+void ShaderVariants::replacePrograms(const std::vector<unsigned int>& programs)
+{
+    for (size_t i = 0; i < variants.size() && i < programs.size(); ++i)
+    {
+        ShaderVariant& variant = variants[i];
+        glDeleteProgram(variant.program);
+        variant.program = programs[i];
+        variant.reflection = reflectProgram(variant.program);
+        for (const auto& block : blockBindings)
+            ::bindUniformBlock(variant.program, variant.reflection, block.first, block.second);
+    }
+}
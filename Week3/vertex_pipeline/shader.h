@@ -0,0 +1,91 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ProgramCache;
+
+// An active uniform as reported by the linker
+struct UniformInfo
+{
+    int location = -1;
+    unsigned int type = 0;
+    int size = 0;
+    int blockIndex = -1;    // -1 for uniforms in the default block
+    int offset = -1;        // byte offset inside the block, -1 for default block uniforms
+};
+
+// An active uniform block and its std140 data size
+struct UniformBlockInfo
+{
+    unsigned int index = 0;
+    int dataSize = 0;
+    int binding = 0;
+};
+
+// Everything the renderer needs to know about a linked program, queried once after link
+struct ShaderReflection
+{
+    std::unordered_map<std::string, UniformInfo> uniforms;
+    std::unordered_map<std::string, UniformBlockInfo> blocks;
+
+    // Location of a default block uniform, or -1 when it was optimized out
+    int location(const std::string& name) const;
+};
+
+// Compile and link a vertex/fragment pair. Returns 0 and prints the log on failure.
+// Each define ("NAME" or "NAME VALUE") is inserted right after the #version line of both stages.
+// Pass retrievable = true when the linked binary will be read back with glGetProgramBinary.
+unsigned int compileProgram(const char* vertexSource, const char* fragmentSource,
+                            const std::vector<std::string>& defines = {}, bool retrievable = false);
+
+// Read a shader source file. Prints an error and returns false when it cannot be read.
+bool loadShaderFile(const std::string& path, std::string& source);
+
+// Insert #define lines after the #version directive of a shader source
+std::string injectDefines(const char* source, const std::vector<std::string>& defines);
+
+// Query every active uniform and uniform block of a linked program
+ShaderReflection reflectProgram(unsigned int program);
+
+// Assign a uniform block to a binding point. Returns false when the block is not active.
+bool bindUniformBlock(unsigned int program, ShaderReflection& reflection, const std::string& name, int binding);
+
+// One specialized program per feature-define set
+struct ShaderVariant
+{
+    std::vector<std::string> defines;
+    unsigned int program = 0;
+    ShaderReflection reflection;
+};
+
+// A family of programs built from the same sources with different define sets.
+// All variants are compiled up front so switching between them never compiles anything.
+class ShaderVariants
+{
+public:
+    // Programs come from the cache when one is given
+    bool build(const char* vertexSource, const char* fragmentSource,
+               const std::vector<std::vector<std::string>>& defineSets, ProgramCache* cache = nullptr);
+    void destroy();
+
+    // Bind a uniform block to the same binding point in every variant
+    void bindUniformBlock(const std::string& name, int binding);
+
+    // Swap in newly linked programs, one per variant in the same order, and reflect them.
+    // Uniform blocks keep their bindings; the old programs are deleted, so anything that
+    // cached their names or uniform locations has to look them up again.
+    void replacePrograms(const std::vector<unsigned int>& programs);
+
+    int count() const { return (int)variants.size(); }
+    const ShaderVariant& operator[](int index) const { return variants[index]; }
+
+private:
+    std::vector<ShaderVariant> variants;
+    std::vector<std::pair<std::string, int>> blockBindings;
+};
+
+#endif
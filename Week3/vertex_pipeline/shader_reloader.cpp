@@ -0,0 +1,188 @@
+#include "shader_reloader.h"
+#include "gl_call_stats.h"
+#include "trace.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+
+bool ShaderReloader::init(Platform& platform, const std::string& vertex, const std::string& fragment,
+                          const std::vector<std::vector<std::string>>& defines)
+{
+    destroy();
+    vertexPath = vertex;
+    fragmentPath = fragment;
+    defineSets = defines;
+    if (!watcher.init({ vertexPath, fragmentPath }))
+        return false;
+    context = platform.createSharedContext();
+    if (!context)
+    {
+        watcher.destroy();
+        return false;
+    }
+    quit = false;
+    starting = true;
+    contextReady = false;
+    worker = std::thread([this]() { workerLoop(); });
+
+    // A worker without a context would take requests and never answer them
+    bool ready = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        started.wait(lock, [this]() { return !starting; });
+        ready = contextReady;
+    }
+    if (!ready)
+    {
+        worker.join();
+        context.reset();
+        watcher.destroy();
+        return false;
+    }
+    return true;
+}
+
+void ShaderReloader::destroy()
+{
+    if (worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+    // A rebuild that finished but was never swapped in
+    for (unsigned int program : built)
+        glDeleteProgram(program);
+    built.clear();
+    finished = false;
+    building = false;
+    context.reset();
+    watcher.destroy();
+}
+
+void ShaderReloader::requestRebuild()
+{
+    building = true;
+    changedAt = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requested = true;
+    }
+    wake.notify_one();
+}
+
+bool ShaderReloader::update(ShaderVariants& variants)
+{
+    if (watcher.changed())
+    {
+        if (building)
+            changedAgain = true;
+        else
+            requestRebuild();
+    }
+    if (!building)
+        return false;
+
+    // The worker only holds the lock to pick up a request or post a result, never while compiling
+    std::vector<unsigned int> programs;
+    bool ok = false;
+    double compileMs = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!finished)
+            return false;
+        finished = false;
+        programs.swap(built);
+        ok = succeeded;
+        compileMs = builtMs;
+    }
+    building = false;
+    counters.compileMs += compileMs;
+
+    if (ok)
+    {
+        TRACE_SCOPE("shader swap");
+        auto swapStart = std::chrono::steady_clock::now();
+        variants.replacePrograms(programs);
+        auto swapEnd = std::chrono::steady_clock::now();
+        const double swapMs = std::chrono::duration<double, std::milli>(swapEnd - swapStart).count();
+        ++counters.reloads;
+        counters.maxSwapMs = std::max(counters.maxSwapMs, swapMs);
+        counters.lastLatencyMs = std::chrono::duration<double, std::milli>(swapEnd - changedAt).count();
+        std::cout << "Reloaded shaders: built in " << compileMs << " ms, live " << counters.lastLatencyMs
+                  << " ms after the change" << std::endl;
+    }
+    else
+    {
+        ++counters.failures;
+        std::cout << "ERROR::SHADER::RELOAD_FAILED keeping the previous programs" << std::endl;
+    }
+
+    // Edits made while this rebuild ran are not in it
+    if (changedAgain)
+    {
+        changedAgain = false;
+        requestRebuild();
+    }
+    return ok;
+}
+
+void ShaderReloader::workerLoop()
+{
+    TRACE_THREAD_NAME("shader compile");
+    glCallStatsIgnoreThread();
+    const bool current = context->makeCurrent(true);
+    if (!current)
+        std::cout << "ERROR::SHADER::RELOAD_CONTEXT_FAILED" << std::endl;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    starting = false;
+    contextReady = current;
+    started.notify_one();
+    if (!current)
+        return;
+    while (true)
+    {
+        wake.wait(lock, [this]() { return quit || requested; });
+        if (quit)
+            break;
+        requested = false;
+        lock.unlock();
+
+        TRACE_SCOPE("shader rebuild");
+        auto start = std::chrono::steady_clock::now();
+        std::vector<unsigned int> programs;
+        std::string vertexSource, fragmentSource;
+        bool ok = loadShaderFile(vertexPath, vertexSource) && loadShaderFile(fragmentPath, fragmentSource);
+        for (size_t i = 0; ok && i < defineSets.size(); ++i)
+        {
+            const unsigned int program = compileProgram(vertexSource.c_str(), fragmentSource.c_str(), defineSets[i]);
+            if (program)
+                programs.push_back(program);
+            else
+                ok = false;
+        }
+        if (!ok)
+        {
+            for (unsigned int program : programs)
+                glDeleteProgram(program);
+            programs.clear();
+        }
+        // The renderer's context only sees the linked programs once this one is done with them
+        glFinish();
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        lock.lock();
+        built.swap(programs);
+        succeeded = ok;
+        builtMs = ms;
+        finished = true;
+    }
+    lock.unlock();
+    context->makeCurrent(false);
+}
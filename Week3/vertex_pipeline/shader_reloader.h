@@ -0,0 +1,80 @@
+#ifndef SHADER_RELOADER_H
+#define SHADER_RELOADER_H
+
+#include "file_watcher.h"
+#include "platform.h"
+#include "shader.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct ShaderReloadStats
+{
+    int reloads = 0;                // rebuilds swapped in
+    int failures = 0;               // rebuilds that did not compile or link; the old programs stayed
+    double compileMs = 0.0;         // total time reading, compiling and linking in the background
+    double maxSwapMs = 0.0;         // longest swap at a frame boundary
+    double lastLatencyMs = 0.0;     // from the last change being seen to its programs being live
+};
+
+// Rebuilds a family of shader variants whenever their source files change. The files are
+// read, compiled and linked on a worker thread with its own context that shares objects
+// with the renderer's, so no frame waits for the compiler. A finished rebuild is swapped in
+// whole between two frames; one that fails leaves the old programs in place and prints the
+// log. Changes made while a rebuild is running start one more rebuild after it.
+class ShaderReloader
+{
+public:
+    // Call on the thread whose context the programs belong to. Waits for the worker to make
+    // its context current and fails, with no worker left running, when it cannot.
+    bool init(Platform& platform, const std::string& vertexPath, const std::string& fragmentPath,
+              const std::vector<std::vector<std::string>>& defineSets);
+    // Call on the thread init() ran on, with the renderer's context current
+    void destroy();
+
+    bool active() const { return worker.joinable(); }
+
+    // Once per frame, before drawing, on the thread that renders: starts a rebuild when the
+    // files changed and swaps a finished one into variants. Returns true when the programs
+    // were replaced; cached program names and uniform locations are stale after that.
+    bool update(ShaderVariants& variants);
+
+    const ShaderReloadStats& stats() const { return counters; }
+
+private:
+    void requestRebuild();
+    void workerLoop();
+
+    FileWatcher watcher;
+    std::unique_ptr<SharedContext> context;
+    std::string vertexPath;
+    std::string fragmentPath;
+    std::vector<std::vector<std::string>> defineSets;
+    std::thread worker;
+
+    // Shared with the worker
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable started;
+    bool starting = false;          // worker has not yet tried its context
+    bool contextReady = false;
+    bool quit = false;
+    bool requested = false;
+    bool finished = false;
+    bool succeeded = false;
+    std::vector<unsigned int> built;
+    double builtMs = 0.0;
+
+    // Render thread only
+    bool building = false;
+    bool changedAgain = false;
+    std::chrono::steady_clock::time_point changedAt;
+    ShaderReloadStats counters;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#version 330 core
+// Each coordinate space is compiled as its own variant (see spaceDefines in main.cpp),
+// so there is no per-vertex branching on the active space.
+layout (location = 0) in vec3 aPos;
+#if defined(INSTANCED)
+// Per-instance placement; the model uniform then holds the rotation shared by every cube
+layout (location = 1) in mat4 instanceModel;
+#endif
+
+uniform mat4 model;
+
+// Per-frame data, filled from one std140 uniform buffer
+layout (std140) uniform FrameData
+{
+    mat4 view;
+    mat4 projection;
+    float time;
+};
+
+out vec3 vertexColor;
+
+void main()
+{
+#if defined(INSTANCED)
+    mat4 placement = instanceModel;
+    mat4 world = instanceModel * model;
+#else
+    mat4 placement = mat4(1.0);
+    mat4 world = model;
+#endif
+#if defined(SPACE_MODEL)
+    // Model space ignores the object's own transform; still transform fully for display
+    gl_Position = projection * view * placement * vec4(aPos, 1.0);
+#else
+    gl_Position = projection * view * world * vec4(aPos, 1.0);
+#endif
+    vertexColor = SPACE_COLOR;
+}
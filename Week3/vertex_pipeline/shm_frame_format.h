@@ -0,0 +1,52 @@
+#ifndef SHM_FRAME_FORMAT_H
+#define SHM_FRAME_FORMAT_H
+
+#include <atomic>
+#include <cstdint>
+
+// Layout of the shared-memory frame ring, shared by the renderer and its consumers. The
+// memfd holds a ShmRingHeader, then slotCount slots of slotBytes each starting at
+// headerBytes. Each slot begins with a ShmSlotHeader, and its pixels follow at pixelOffset
+// from the start of the slot. Offsets are page aligned, so a consumer can map one slot alone.
+
+const uint32_t SHM_RING_MAGIC = 0x52465056;     // "VPFR"
+const uint32_t SHM_RING_VERSION = 1;
+const uint32_t SHM_PIXELS_RGBA8 = 1;            // 8-bit RGBA, top row first
+
+struct ShmRingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;                // bytes per pixel row
+    uint32_t pixelFormat;
+    uint32_t reserved;
+    uint64_t headerBytes;
+    uint64_t slotBytes;
+    uint64_t pixelOffset;
+
+    // Frames published so far. Frame n of the ring lives in slot n % slotCount; the newest
+    // slotCount - 1 are stable while the producer fills the next one.
+    alignas(64) std::atomic<uint64_t> published;
+    // Futex word, bumped with published; consumers sleep on it changing
+    std::atomic<uint32_t> wakeCount;
+    std::atomic<uint32_t> waiters;      // consumers in FUTEX_WAIT; the producer skips the wake at zero
+    std::atomic<uint32_t> closed;       // nonzero once the producer has gone
+};
+
+struct ShmSlotHeader
+{
+    // Sequence lock: odd while the producer writes the slot, 2 * (n + 1) once it holds
+    // ring frame n. A consumer checks it before and after using the pixels.
+    std::atomic<uint64_t> sequence;
+    int64_t frame;                  // renderer frame number
+    int64_t renderedNs;             // CLOCK_MONOTONIC when the frame was read back
+    int64_t publishedNs;            // CLOCK_MONOTONIC when the slot was complete
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "ring counters are shared between processes and must be lock-free");
+
+#endif
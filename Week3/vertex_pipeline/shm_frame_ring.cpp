@@ -0,0 +1,374 @@
+#include "shm_frame_ring.h"
+
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <new>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+    const size_t PAGE_BYTES = 4096;
+
+    size_t alignToPage(size_t bytes)
+    {
+        return (bytes + PAGE_BYTES - 1) / PAGE_BYTES * PAGE_BYTES;
+    }
+
+    // Shared (not private) futex operations, so they work across processes mapping the ring
+    void futexWake(std::atomic<uint32_t>* word)
+    {
+        syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    void futexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeoutMs)
+    {
+        timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (long)(timeoutMs % 1000) * 1000000L;
+        syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    }
+
+    bool socketAddress(const std::string& path, sockaddr_un& address)
+    {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            std::cout << "ERROR::SHM::SOCKET_PATH_TOO_LONG " << path << std::endl;
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return true;
+    }
+}
+
+int64_t monotonicNanoseconds()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+bool ShmFrameWriter::init(const std::string& path, int width, int height, int slots)
+{
+    const size_t stride = (size_t)width * 4;
+    const size_t headerBytes = alignToPage(sizeof(ShmRingHeader));
+    const size_t pixelOffset = alignToPage(sizeof(ShmSlotHeader));
+    const size_t slotBytes = pixelOffset + alignToPage(stride * (size_t)height);
+    mappedBytes = headerBytes + slotBytes * (size_t)slots;
+
+    // Sealed at its size, so consumers can map it without fearing a truncate under them
+    memfd = (int)syscall(SYS_memfd_create, "vertex_pipeline_frames", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0 || ftruncate(memfd, (off_t)mappedBytes) != 0 ||
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0)
+    {
+        std::cout << "ERROR::SHM::MEMFD_FAILED " << std::strerror(errno) << std::endl;
+        destroy();
+        return false;
+    }
+    void* mapping = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        std::cout << "ERROR::SHM::MAP_FAILED " << std::strerror(errno) << std::endl;
+        destroy();
+        return false;
+    }
+    base = (uint8_t*)mapping;
+
+    // A fresh memfd reads as zeros, so the counters and sequences already start at zero
+    ShmRingHeader* header = new (base) ShmRingHeader();
+    header->magic = SHM_RING_MAGIC;
+    header->version = SHM_RING_VERSION;
+    header->slotCount = (uint32_t)slots;
+    header->width = (uint32_t)width;
+    header->height = (uint32_t)height;
+    header->stride = (uint32_t)stride;
+    header->pixelFormat = SHM_PIXELS_RGBA8;
+    header->headerBytes = headerBytes;
+    header->slotBytes = slotBytes;
+    header->pixelOffset = pixelOffset;
+    for (int i = 0; i < slots; ++i)
+        new (base + headerBytes + slotBytes * (size_t)i) ShmSlotHeader();
+
+    sockaddr_un address;
+    if (!socketAddress(path, address))
+    {
+        destroy();
+        return false;
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    unlink(path.c_str());
+    if (listenFd < 0 || bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 8) != 0)
+    {
+        std::cout << "ERROR::SHM::CANNOT_LISTEN " << path << ": " << std::strerror(errno) << std::endl;
+        destroy();
+        return false;
+    }
+    socketPath = path;
+    return true;
+}
+
+void ShmFrameWriter::destroy()
+{
+    if (base)
+    {
+        ShmRingHeader* header = (ShmRingHeader*)base;
+        header->closed.store(1);
+        header->wakeCount.fetch_add(1);
+        futexWake(&header->wakeCount);
+        munmap(base, mappedBytes);
+        base = nullptr;
+    }
+    if (listenFd >= 0)
+    {
+        ::close(listenFd);
+        unlink(socketPath.c_str());
+        listenFd = -1;
+    }
+    if (memfd >= 0)
+    {
+        ::close(memfd);
+        memfd = -1;
+    }
+}
+
+void ShmFrameWriter::serveConsumers()
+{
+    while (true)
+    {
+        int connection = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (connection < 0)
+            return;
+
+        // One byte of payload carrying the descriptor as SCM_RIGHTS
+        char payload = 'F';
+        iovec io = { &payload, 1 };
+        char control[CMSG_SPACE(sizeof(int))];
+        std::memset(control, 0, sizeof(control));
+        msghdr message;
+        std::memset(&message, 0, sizeof(message));
+        message.msg_iov = &io;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        cmsghdr* descriptor = CMSG_FIRSTHDR(&message);
+        descriptor->cmsg_level = SOL_SOCKET;
+        descriptor->cmsg_type = SCM_RIGHTS;
+        descriptor->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(descriptor), &memfd, sizeof(int));
+        if (sendmsg(connection, &message, MSG_NOSIGNAL) == 1)
+            ++counters.consumers;
+        ::close(connection);
+    }
+}
+
+void ShmFrameWriter::publish(int64_t frame, const uint8_t* pixels, bool bottomUp, int64_t renderedNs)
+{
+    serveConsumers();
+
+    ShmRingHeader* header = (ShmRingHeader*)base;
+    const uint64_t index = header->published.load(std::memory_order_relaxed);
+    uint8_t* slot = base + header->headerBytes + header->slotBytes * (index % header->slotCount);
+    ShmSlotHeader* slotHeader = (ShmSlotHeader*)slot;
+
+    auto copyStart = std::chrono::steady_clock::now();
+    slotHeader->sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    uint8_t* destination = slot + header->pixelOffset;
+    const size_t stride = header->stride;
+    const int height = (int)header->height;
+    if (bottomUp)
+    {
+        for (int y = 0; y < height; ++y)
+            std::memcpy(destination + (size_t)y * stride, pixels + (size_t)(height - 1 - y) * stride, stride);
+    }
+    else
+    {
+        std::memcpy(destination, pixels, stride * (size_t)height);
+    }
+    slotHeader->frame = frame;
+    slotHeader->renderedNs = renderedNs;
+    slotHeader->publishedNs = monotonicNanoseconds();
+    slotHeader->sequence.store(2 * (index + 1), std::memory_order_release);
+    counters.copyMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - copyStart).count();
+
+    // Publish, then look for sleepers. Consumers raise waiters before rechecking the count,
+    // so with both sides sequentially consistent one of them always sees the other.
+    header->published.store(index + 1);
+    header->wakeCount.fetch_add(1);
+    if (header->waiters.load() > 0)
+    {
+        futexWake(&header->wakeCount);
+        ++counters.wakes;
+    }
+    ++counters.published;
+}
+
+bool ShmFrameReader::connect(const std::string& socketPath)
+{
+    sockaddr_un address;
+    if (!socketAddress(socketPath, address))
+        return false;
+    int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (connection < 0 || ::connect(connection, (sockaddr*)&address, sizeof(address)) != 0)
+    {
+        std::cout << "ERROR::SHM::CANNOT_CONNECT " << socketPath << ": " << std::strerror(errno) << std::endl;
+        if (connection >= 0)
+            ::close(connection);
+        return false;
+    }
+
+    char payload = 0;
+    iovec io = { &payload, 1 };
+    char control[CMSG_SPACE(sizeof(int))];
+    msghdr message;
+    std::memset(&message, 0, sizeof(message));
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    int fd = -1;
+    if (recvmsg(connection, &message, MSG_CMSG_CLOEXEC) == 1)
+    {
+        cmsghdr* descriptor = CMSG_FIRSTHDR(&message);
+        if (descriptor && descriptor->cmsg_level == SOL_SOCKET && descriptor->cmsg_type == SCM_RIGHTS)
+            std::memcpy(&fd, CMSG_DATA(descriptor), sizeof(int));
+    }
+    ::close(connection);
+    if (fd < 0)
+    {
+        std::cout << "ERROR::SHM::NO_DESCRIPTOR from " << socketPath << std::endl;
+        return false;
+    }
+
+    const bool mapped = map(fd);
+    // The mapping keeps the memory alive on its own
+    ::close(fd);
+    return mapped;
+}
+
+bool ShmFrameReader::map(int fd)
+{
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(ShmRingHeader))
+        return false;
+    // Writable only so the reader can count itself in waiters; pixels are never written
+    void* mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED)
+        return false;
+    base = (uint8_t*)mapping;
+    mappedBytes = (size_t)info.st_size;
+
+    const ShmRingHeader& ring = header();
+    if (ring.magic != SHM_RING_MAGIC || ring.version != SHM_RING_VERSION || ring.pixelFormat != SHM_PIXELS_RGBA8)
+    {
+        std::cout << "ERROR::SHM::BAD_RING version " << ring.version << std::endl;
+        close();
+        return false;
+    }
+    // The layout comes from another process: every slot, and every row of pixels in it,
+    // must lie inside the mapping, and acquire() needs at least one stable slot
+    const uint64_t rowBytes = (uint64_t)ring.width * 4;
+    const uint64_t pixelBytes = (uint64_t)ring.stride * ring.height;
+    if (ring.slotCount < 2 || ring.stride < rowBytes ||
+        ring.headerBytes < sizeof(ShmRingHeader) || ring.headerBytes > mappedBytes ||
+        ring.pixelOffset < sizeof(ShmSlotHeader) || ring.pixelOffset > ring.slotBytes ||
+        pixelBytes > ring.slotBytes - ring.pixelOffset ||
+        ring.slotBytes > (mappedBytes - ring.headerBytes) / ring.slotCount)
+    {
+        std::cout << "ERROR::SHM::BAD_RING_LAYOUT " << ring.slotCount << " slots of " << ring.slotBytes << " bytes, stride "
+                  << ring.stride << " for " << ring.width << "x" << ring.height << " at offset " << ring.pixelOffset
+                  << ", in " << mappedBytes << " bytes" << std::endl;
+        close();
+        return false;
+    }
+    // Start at the newest complete frame
+    const uint64_t published = ring.published.load();
+    nextIndex = published > 0 ? published - 1 : 0;
+    return true;
+}
+
+void ShmFrameReader::close()
+{
+    if (base)
+        munmap(base, mappedBytes);
+    base = nullptr;
+    mappedBytes = 0;
+}
+
+ShmSlotHeader& ShmFrameReader::slotHeader(uint64_t index) const
+{
+    const ShmRingHeader& ring = header();
+    return *(ShmSlotHeader*)(base + ring.headerBytes + ring.slotBytes * (index % ring.slotCount));
+}
+
+bool ShmFrameReader::acquire(ShmFrameView& view, int timeoutMs)
+{
+    ShmRingHeader& ring = *(ShmRingHeader*)base;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true)
+    {
+        const uint32_t wake = ring.wakeCount.load();
+        const uint64_t published = ring.published.load();
+        if (published > nextIndex)
+        {
+            // Frames older than the newest slotCount - 1 may be under rewrite; skip to those
+            const uint64_t oldestStable = published > ring.slotCount - 1 ? published - (ring.slotCount - 1) : 0;
+            if (nextIndex < oldestStable)
+            {
+                counters.dropped += oldestStable - nextIndex;
+                nextIndex = oldestStable;
+            }
+
+            ShmSlotHeader& slot = slotHeader(nextIndex);
+            if (slot.sequence.load(std::memory_order_acquire) != 2 * (nextIndex + 1))
+            {
+                // Overwritten between the two loads: the producer lapped us, look again
+                ++counters.dropped;
+                ++nextIndex;
+                continue;
+            }
+            view.index = nextIndex;
+            view.frame = slot.frame;
+            view.renderedNs = slot.renderedNs;
+            view.publishedNs = slot.publishedNs;
+            view.width = (int)ring.width;
+            view.height = (int)ring.height;
+            view.stride = (int)ring.stride;
+            view.pixels = (const uint8_t*)&slot + ring.pixelOffset;
+            ++nextIndex;
+            ++counters.frames;
+            return true;
+        }
+        if (ring.closed.load() != 0)
+            return false;
+
+        const int remainingMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remainingMs <= 0)
+            return false;
+        ring.waiters.fetch_add(1);
+        if (ring.published.load() == published)
+            futexWait(&ring.wakeCount, wake, remainingMs);
+        ring.waiters.fetch_sub(1);
+    }
+}
+
+bool ShmFrameReader::release(const ShmFrameView& view)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slotHeader(view.index).sequence.load(std::memory_order_relaxed) == 2 * (view.index + 1))
+        return true;
+    ++counters.torn;
+    return false;
+}
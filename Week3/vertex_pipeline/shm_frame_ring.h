@@ -0,0 +1,105 @@
+#ifndef SHM_FRAME_RING_H
+#define SHM_FRAME_RING_H
+
+#include "shm_frame_format.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// CLOCK_MONOTONIC in nanoseconds, comparable between processes on one host
+int64_t monotonicNanoseconds();
+
+struct ShmWriterStats
+{
+    uint64_t published = 0;
+    uint64_t wakes = 0;             // futex wake calls, only made while someone waits
+    uint64_t consumers = 0;         // consumers handed the ring
+    double copyMs = 0.0;            // total time copying frames into slots
+};
+
+// Producer side of the ring. The ring is a sealed memfd; consumers connect to a UNIX socket
+// at socketPath and receive its descriptor, then map it and read frames in place. The
+// producer never waits for consumers: a consumer that falls slotCount - 1 frames behind
+// skips ahead, and one that holds a slot too long sees its sequence change.
+class ShmFrameWriter
+{
+public:
+    static const int SLOTS = 4;
+
+    bool init(const std::string& path, int width, int height, int slots = SLOTS);
+    // Marks the ring closed, wakes every consumer and removes the socket
+    void destroy();
+
+    bool active() const { return base != nullptr; }
+
+    // Copy a frame into the next slot and publish it. rows are width * 4 bytes each; GL
+    // readbacks come bottom row first, so bottomUp flips them into the ring's top-down order.
+    // Also hands the ring to consumers that connected since the last frame.
+    void publish(int64_t frame, const uint8_t* pixels, bool bottomUp, int64_t renderedNs);
+
+    const ShmWriterStats& stats() const { return counters; }
+
+private:
+    void serveConsumers();
+
+    std::string socketPath;
+    int memfd = -1;
+    int listenFd = -1;
+    uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    ShmWriterStats counters;
+};
+
+// A frame as it sits in the ring. pixels points into the shared mapping.
+struct ShmFrameView
+{
+    uint64_t index = 0;             // position in the ring's sequence of published frames
+    int64_t frame = 0;
+    int64_t renderedNs = 0;
+    int64_t publishedNs = 0;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    const uint8_t* pixels = nullptr;
+};
+
+struct ShmReaderStats
+{
+    uint64_t frames = 0;            // frames acquired
+    uint64_t dropped = 0;           // frames published but skipped because the reader was behind
+    uint64_t torn = 0;              // frames overwritten while the reader was still using them
+};
+
+// Consumer side of the ring
+class ShmFrameReader
+{
+public:
+    ~ShmFrameReader() { close(); }
+
+    // Connect to a producer's socket and map the ring it sends
+    bool connect(const std::string& socketPath);
+    void close();
+
+    const ShmRingHeader& header() const { return *(const ShmRingHeader*)base; }
+
+    // Wait up to timeoutMs for a frame newer than the last one acquired and point view at
+    // it. Returns false on timeout or once the producer has closed the ring.
+    bool acquire(ShmFrameView& view, int timeoutMs);
+
+    // Whether the frame was still intact when the reader finished with it
+    bool release(const ShmFrameView& view);
+
+    const ShmReaderStats& stats() const { return counters; }
+
+private:
+    bool map(int fd);
+    ShmSlotHeader& slotHeader(uint64_t index) const;
+
+    uint8_t* base = nullptr;
+    size_t mappedBytes = 0;
+    uint64_t nextIndex = 0;
+    ShmReaderStats counters;
+};
+
+#endif
@@ -0,0 +1,456 @@
+#include "software_rasterizer.h"
+#include "job_system.h"
+#include "mesh.h"
+#include "scene.h"
+#include "trace.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+    // Triangles set up per batch; bounds the scratch memory for very large scenes
+    const size_t MAX_BATCH_TRIANGLES = 1u << 20;
+
+    const int SUBPIXEL_BITS = 8;
+    const int64_t SUBPIXEL_ONE = 1 << SUBPIXEL_BITS;
+    const int64_t SUBPIXEL_HALF = SUBPIXEL_ONE / 2;
+
+    uint32_t packColor(const glm::vec3& c)
+    {
+        auto channel = [](float v) { return (uint32_t)std::lround(std::min(std::max(v, 0.0f), 1.0f) * 255.0f); };
+        return channel(c.x) | (channel(c.y) << 8) | (channel(c.z) << 16) | (255u << 24);
+    }
+
+    // Signed distance to each frustum plane in clip space; negative is outside
+    float planeDistance(const glm::vec4& v, int plane)
+    {
+        switch (plane) {
+            case 0: return v.w + v.x;
+            case 1: return v.w - v.x;
+            case 2: return v.w + v.y;
+            case 3: return v.w - v.y;
+            case 4: return v.w + v.z;
+            default: return v.w - v.z;
+        }
+    }
+
+    int outcode(const glm::vec4& v)
+    {
+        int code = 0;
+        for (int plane = 0; plane < 6; ++plane)
+        {
+            if (planeDistance(v, plane) < 0.0f)
+                code |= 1 << plane;
+        }
+        return code;
+    }
+
+    // Sutherland-Hodgman against one plane. A triangle clipped by all six planes has at most 9 vertices.
+    int clipPolygon(const glm::vec4* in, int count, glm::vec4* out, int plane)
+    {
+        int written = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            const glm::vec4& a = in[i];
+            const glm::vec4& b = in[(i + 1) % count];
+            float da = planeDistance(a, plane);
+            float db = planeDistance(b, plane);
+            if (da >= 0.0f)
+                out[written++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f))
+            {
+                float t = da / (da - db);
+                out[written++] = a + (b - a) * t;
+            }
+        }
+        return written;
+    }
+}
+
+SoftwareRasterizer::SoftwareRasterizer(JobSystem& jobSystem)
+    : jobs(jobSystem)
+{
+}
+
+void SoftwareRasterizer::resize(int width, int height)
+{
+    targetWidth = width;
+    targetHeight = height;
+    tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    color.assign((size_t)width * (size_t)height, 0);
+    depth.assign((size_t)width * (size_t)height, 1.0f);
+    tileStats.assign((size_t)(tilesX * tilesY), RasterStats());
+}
+
+void SoftwareRasterizer::clear(const glm::vec3& clearColor, float clearDepth)
+{
+    std::fill(color.begin(), color.end(), packColor(clearColor));
+    std::fill(depth.begin(), depth.end(), clearDepth);
+}
+
+void SoftwareRasterizer::draw(const float* positions, int baseVertex, unsigned int vertexCount,
+                              const unsigned int* indices, unsigned int indexCount,
+                              const glm::mat4& mvp, const glm::vec3& drawColor)
+{
+    draws.push_back(DrawCall{ positions, baseVertex, vertexCount, indices, indexCount, mvp, packColor(drawColor) });
+}
+
+void SoftwareRasterizer::flush()
+{
+    // Split the queue into batches of bounded size, keeping submission order
+    size_t first = 0;
+    size_t batchTriangles = 0;
+    for (size_t i = 0; i < draws.size(); ++i)
+    {
+        size_t drawTriangles = draws[i].indexCount / 3;
+        if (batchTriangles > 0 && batchTriangles + drawTriangles > MAX_BATCH_TRIANGLES)
+        {
+            flushBatch(first, i);
+            first = i;
+            batchTriangles = 0;
+        }
+        batchTriangles += drawTriangles;
+    }
+    if (first < draws.size())
+        flushBatch(first, draws.size());
+    draws.clear();
+}
+
+void SoftwareRasterizer::flushBatch(size_t firstDraw, size_t lastDraw)
+{
+    const size_t drawCount = lastDraw - firstDraw;
+    const int tileCount = tilesX * tilesY;
+
+    // Where each draw's vertices and triangles start inside the batch
+    drawVertexStart.resize(drawCount + 1);
+    drawTriangleStart.resize(drawCount + 1);
+    drawVertexStart[0] = 0;
+    drawTriangleStart[0] = 0;
+    for (size_t i = 0; i < drawCount; ++i)
+    {
+        drawVertexStart[i + 1] = drawVertexStart[i] + draws[firstDraw + i].vertexCount;
+        drawTriangleStart[i + 1] = drawTriangleStart[i] + draws[firstDraw + i].indexCount / 3;
+    }
+    const size_t vertexCount = drawVertexStart[drawCount];
+    const size_t triangleCount = drawTriangleStart[drawCount];
+    counters.trianglesIn += triangleCount;
+    if (triangleCount == 0)
+        return;
+
+    clipX.resize(vertexCount);
+    clipY.resize(vertexCount);
+    clipZ.resize(vertexCount);
+    clipW.resize(vertexCount);
+
+    // Vertex stage: every draw's vertices to clip space
+    const size_t drawsPerJob = std::max<size_t>(1, drawCount / (size_t)(jobs.threadCount() * 4));
+    for (size_t start = 0; start < drawCount; start += drawsPerJob)
+    {
+        size_t end = std::min(drawCount, start + drawsPerJob);
+        jobs.submit([this, firstDraw, start, end]() {
+            TRACE_SCOPE("raster vertex");
+            for (size_t d = start; d < end; ++d)
+            {
+                const DrawCall& call = draws[firstDraw + d];
+                const float* source = call.positions + (size_t)call.baseVertex * 3;
+                size_t slot = drawVertexStart[d];
+                for (unsigned int v = 0; v < call.vertexCount; ++v, ++slot)
+                {
+                    glm::vec4 clip = call.mvp * glm::vec4(source[v * 3], source[v * 3 + 1], source[v * 3 + 2], 1.0f);
+                    clipX[slot] = clip.x;
+                    clipY[slot] = clip.y;
+                    clipZ[slot] = clip.z;
+                    clipW[slot] = clip.w;
+                }
+            }
+        });
+    }
+    jobs.wait();
+
+    // Setup and binning: contiguous triangle ranges so each chunk's bins stay in draw order
+    chunkCount = (int)std::min<size_t>((size_t)jobs.threadCount() * 2, std::max<size_t>(1, triangleCount / 256));
+    chunkCount = std::max(chunkCount, 1);
+    triangles.resize(chunkCount);
+    bins.resize((size_t)chunkCount * (size_t)tileCount);
+    chunkStats.assign(chunkCount, RasterStats());
+    for (auto& list : triangles)
+        list.clear();
+    for (auto& bin : bins)
+        bin.clear();
+
+    size_t drawCursor = 0;
+    for (int chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        size_t firstTriangle = triangleCount * (size_t)chunk / (size_t)chunkCount;
+        size_t lastTriangle = triangleCount * (size_t)(chunk + 1) / (size_t)chunkCount;
+        while (drawTriangleStart[drawCursor + 1] <= firstTriangle && drawCursor + 1 < drawCount)
+            ++drawCursor;
+        jobs.submit([this, chunk, firstTriangle, lastTriangle, firstDraw, drawCursor]() {
+            setupChunk(chunk, firstTriangle, lastTriangle, firstDraw, drawCursor);
+        });
+    }
+    jobs.wait();
+
+    // Raster stage: tiles are independent, so each one is its own job
+    for (int tile = 0; tile < tileCount; ++tile)
+        jobs.submit([this, tile]() { rasterizeTile(tile); });
+    jobs.wait();
+
+    for (const RasterStats& s : chunkStats)
+        counters.trianglesDrawn += s.trianglesDrawn;
+    for (RasterStats& s : tileStats)
+    {
+        counters.fragments += s.fragments;
+        counters.pixelsWritten += s.pixelsWritten;
+        s = RasterStats();
+    }
+}
+
+void SoftwareRasterizer::setupChunk(int chunk, size_t firstTriangle, size_t lastTriangle,
+                                    size_t firstDraw, size_t batchDraw)
+{
+    TRACE_SCOPE("raster setup");
+    glm::vec4 clip[3];
+    for (size_t t = firstTriangle; t < lastTriangle; ++t)
+    {
+        while (drawTriangleStart[batchDraw + 1] <= t)
+            ++batchDraw;
+        const DrawCall& call = draws[firstDraw + batchDraw];
+        const unsigned int* index = call.indices + (t - drawTriangleStart[batchDraw]) * 3;
+        for (int k = 0; k < 3; ++k)
+        {
+            size_t slot = drawVertexStart[batchDraw] + index[k];
+            clip[k] = glm::vec4(clipX[slot], clipY[slot], clipZ[slot], clipW[slot]);
+        }
+        setupTriangle(chunk, clip, call.color);
+    }
+}
+
+void SoftwareRasterizer::setupTriangle(int chunk, const glm::vec4* clip, uint32_t triangleColor)
+{
+    int codes[3] = { outcode(clip[0]), outcode(clip[1]), outcode(clip[2]) };
+
+    // Entirely outside one plane: nothing to draw
+    if (codes[0] & codes[1] & codes[2])
+        return;
+
+    // Entirely inside: no clipping needed
+    int crossed = codes[0] | codes[1] | codes[2];
+    if (crossed == 0)
+    {
+        emitTriangle(chunk, clip[0], clip[1], clip[2], triangleColor);
+        return;
+    }
+
+    // Clip against only the planes the triangle crosses, then fan out the polygon
+    glm::vec4 bufferA[12], bufferB[12];
+    glm::vec4* in = bufferA;
+    glm::vec4* out = bufferB;
+    in[0] = clip[0];
+    in[1] = clip[1];
+    in[2] = clip[2];
+    int count = 3;
+    for (int plane = 0; plane < 6 && count >= 3; ++plane)
+    {
+        if (!(crossed & (1 << plane)))
+            continue;
+        count = clipPolygon(in, count, out, plane);
+        std::swap(in, out);
+    }
+    for (int i = 1; i + 1 < count; ++i)
+        emitTriangle(chunk, in[0], in[i], in[i + 1], triangleColor);
+}
+
+void SoftwareRasterizer::emitTriangle(int chunk, const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, uint32_t triangleColor)
+{
+    // Perspective divide and viewport transform, glDepthRange(0, 1)
+    const glm::vec4* clip[3] = { &a, &b, &c };
+    SetupTriangle tri;
+    float fx[3], fy[3], fz[3];
+    for (int k = 0; k < 3; ++k)
+    {
+        float invW = 1.0f / clip[k]->w;
+        fx[k] = (clip[k]->x * invW * 0.5f + 0.5f) * (float)targetWidth;
+        fy[k] = (clip[k]->y * invW * 0.5f + 0.5f) * (float)targetHeight;
+        fz[k] = clip[k]->z * invW * 0.5f + 0.5f;
+        tri.x[k] = (int64_t)std::llround(fx[k] * (float)SUBPIXEL_ONE);
+        tri.y[k] = (int64_t)std::llround(fy[k] * (float)SUBPIXEL_ONE);
+    }
+
+    // No face culling, like the GL path: orient every triangle counter-clockwise
+    int64_t area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+    if (area == 0)
+        return;
+    if (area < 0)
+    {
+        std::swap(tri.x[1], tri.x[2]);
+        std::swap(tri.y[1], tri.y[2]);
+        std::swap(fz[1], fz[2]);
+    }
+
+    // Depth plane in pixel units, anchored at vertex 0
+    double x0 = (double)tri.x[0] / SUBPIXEL_ONE, y0 = (double)tri.y[0] / SUBPIXEL_ONE;
+    double d1x = (double)tri.x[1] / SUBPIXEL_ONE - x0, d1y = (double)tri.y[1] / SUBPIXEL_ONE - y0;
+    double d2x = (double)tri.x[2] / SUBPIXEL_ONE - x0, d2y = (double)tri.y[2] / SUBPIXEL_ONE - y0;
+    double denom = d1x * d2y - d2x * d1y;
+    double dz1 = fz[1] - fz[0], dz2 = fz[2] - fz[0];
+    tri.z0 = fz[0];
+    tri.dzdx = (float)((dz1 * d2y - dz2 * d1y) / denom);
+    tri.dzdy = (float)((dz2 * d1x - dz1 * d2x) / denom);
+
+    // Pixels whose centers can be covered
+    int64_t minFx = std::min(std::min(tri.x[0], tri.x[1]), tri.x[2]);
+    int64_t maxFx = std::max(std::max(tri.x[0], tri.x[1]), tri.x[2]);
+    int64_t minFy = std::min(std::min(tri.y[0], tri.y[1]), tri.y[2]);
+    int64_t maxFy = std::max(std::max(tri.y[0], tri.y[1]), tri.y[2]);
+    tri.minX = std::max(0, (int)((minFx - SUBPIXEL_HALF + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS));
+    tri.minY = std::max(0, (int)((minFy - SUBPIXEL_HALF + SUBPIXEL_ONE - 1) >> SUBPIXEL_BITS));
+    tri.maxX = std::min(targetWidth - 1, (int)((maxFx - SUBPIXEL_HALF) >> SUBPIXEL_BITS));
+    tri.maxY = std::min(targetHeight - 1, (int)((maxFy - SUBPIXEL_HALF) >> SUBPIXEL_BITS));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+        return;
+    tri.color = triangleColor;
+
+    std::vector<SetupTriangle>& list = triangles[chunk];
+    uint32_t index = (uint32_t)list.size();
+    list.push_back(tri);
+    ++chunkStats[chunk].trianglesDrawn;
+
+    const int tileCount = tilesX * tilesY;
+    for (int ty = tri.minY / TILE_SIZE; ty <= tri.maxY / TILE_SIZE; ++ty)
+    {
+        for (int tx = tri.minX / TILE_SIZE; tx <= tri.maxX / TILE_SIZE; ++tx)
+            bins[(size_t)chunk * (size_t)tileCount + (size_t)(ty * tilesX + tx)].push_back(index);
+    }
+}
+
+void SoftwareRasterizer::rasterizeTile(int tile)
+{
+    TRACE_SCOPE("raster tile");
+    const int tileCount = tilesX * tilesY;
+    const int tileMinX = (tile % tilesX) * TILE_SIZE;
+    const int tileMinY = (tile / tilesX) * TILE_SIZE;
+    const int tileMaxX = std::min(tileMinX + TILE_SIZE, targetWidth) - 1;
+    const int tileMaxY = std::min(tileMinY + TILE_SIZE, targetHeight) - 1;
+    RasterStats& stats = tileStats[tile];
+
+    // Chunks in order, then bin entries in order: the same order the draws were submitted
+    for (int chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        const std::vector<uint32_t>& bin = bins[(size_t)chunk * (size_t)tileCount + (size_t)tile];
+        const std::vector<SetupTriangle>& list = triangles[chunk];
+        for (uint32_t index : bin)
+        {
+            const SetupTriangle& tri = list[index];
+            const int minX = std::max(tri.minX, tileMinX);
+            const int maxX = std::min(tri.maxX, tileMaxX);
+            const int minY = std::max(tri.minY, tileMinY);
+            const int maxY = std::min(tri.maxY, tileMaxY);
+            if (minX > maxX || minY > maxY)
+                continue;
+
+            // Edge functions for v1->v2, v2->v0, v0->v1 at the first pixel center,
+            // with a -1 bias on edges that are not top or left so shared edges are drawn once
+            int64_t rowEdge[3], stepX[3], stepY[3], bias[3];
+            const int64_t px = (int64_t)minX * SUBPIXEL_ONE + SUBPIXEL_HALF;
+            const int64_t py = (int64_t)minY * SUBPIXEL_ONE + SUBPIXEL_HALF;
+            for (int e = 0; e < 3; ++e)
+            {
+                int a = (e + 1) % 3, b = (e + 2) % 3;
+                int64_t dx = tri.x[b] - tri.x[a];
+                int64_t dy = tri.y[b] - tri.y[a];
+                rowEdge[e] = dx * (py - tri.y[a]) - dy * (px - tri.x[a]);
+                stepX[e] = -dy * SUBPIXEL_ONE;
+                stepY[e] = dx * SUBPIXEL_ONE;
+                bool topLeft = dy < 0 || (dy == 0 && dx < 0);
+                bias[e] = topLeft ? 0 : -1;
+            }
+
+            const float startZ = tri.z0 + tri.dzdx * ((float)minX + 0.5f - (float)tri.x[0] / SUBPIXEL_ONE)
+                                        + tri.dzdy * ((float)minY + 0.5f - (float)tri.y[0] / SUBPIXEL_ONE);
+            for (int y = minY; y <= maxY; ++y)
+            {
+                int64_t e0 = rowEdge[0] + bias[0];
+                int64_t e1 = rowEdge[1] + bias[1];
+                int64_t e2 = rowEdge[2] + bias[2];
+                float z = startZ + tri.dzdy * (float)(y - minY);
+                size_t pixel = (size_t)y * (size_t)targetWidth + (size_t)minX;
+                for (int x = minX; x <= maxX; ++x, ++pixel)
+                {
+                    if ((e0 | e1 | e2) >= 0)
+                    {
+                        ++stats.fragments;
+                        if (z < depth[pixel])
+                        {
+                            depth[pixel] = z;
+                            color[pixel] = tri.color;
+                            ++stats.pixelsWritten;
+                        }
+                    }
+                    e0 += stepX[0];
+                    e1 += stepX[1];
+                    e2 += stepX[2];
+                    z += tri.dzdx;
+                }
+                rowEdge[0] += stepY[0];
+                rowEdge[1] += stepY[1];
+                rowEdge[2] += stepY[2];
+            }
+        }
+    }
+}
+
+void renderSceneSoftware(SoftwareRasterizer& raster, const SceneLayout& scene, const MeshRegistry& meshes,
+                         const std::vector<int>& objectMeshes, int activeSpace, bool instanced, float time)
+{
+    raster.clear(glm::vec3(0.1f, 0.1f, 0.1f));
+
+    const glm::mat4 viewProjection = sceneProjection(scene, raster.width(), raster.height()) * sceneView(scene);
+    const glm::vec3 drawColor = spaceColor(activeSpace);
+    const float* positions = meshes.positions().data();
+    const unsigned int* indices = meshes.indices().data();
+
+    for (size_t i = 0; i < scene.positions.size(); ++i)
+    {
+        const MeshRange& mesh = meshes.range(objectMeshes.empty() ? 0 : objectMeshes[i]);
+
+        // Same model-space rule as the shader variants: the instanced shader keeps the
+        // placement, the per-draw shader drops the whole model matrix
+        glm::mat4 model;
+        if (activeSpace != MODEL_SPACE)
+            model = objectModel(scene.positions[i], time);
+        else if (instanced)
+            model = glm::translate(glm::mat4(1.0f), scene.positions[i]);
+        else
+            model = glm::mat4(1.0f);
+
+        raster.draw(positions, mesh.baseVertex, mesh.vertexCount, indices + mesh.firstIndex, mesh.indexCount,
+                    viewProjection * model, drawColor);
+    }
+    raster.flush();
+}
+
+ImageDiff compareImages(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, int tolerance)
+{
+    ImageDiff diff;
+    diff.pixels = std::min(a.size(), b.size());
+    for (size_t i = 0; i < diff.pixels; ++i)
+    {
+        int worst = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+        {
+            int ca = (int)((a[i] >> shift) & 0xff);
+            int cb = (int)((b[i] >> shift) & 0xff);
+            worst = std::max(worst, std::abs(ca - cb));
+        }
+        diff.maxChannelDiff = std::max(diff.maxChannelDiff, worst);
+        if (worst > tolerance)
+            ++diff.mismatched;
+    }
+    return diff;
+}
@@ -0,0 +1,123 @@
+#ifndef SOFTWARE_RASTERIZER_H
+#define SOFTWARE_RASTERIZER_H
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+class JobSystem;
+class MeshRegistry;
+struct SceneLayout;
+
+// Counters for everything drawn since the last resetStats()
+struct RasterStats
+{
+    uint64_t trianglesIn = 0;       // triangles submitted
+    uint64_t trianglesDrawn = 0;    // triangles left after clipping and degenerate rejection
+    uint64_t fragments = 0;         // pixels covered and depth tested
+    uint64_t pixelsWritten = 0;     // pixels that passed the depth test
+};
+
+// CPU implementation of the same pipeline the GL path runs: vertex transform, homogeneous
+// clipping against the six frustum planes, perspective divide and viewport transform,
+// then binning into screen tiles that are rasterized and depth tested in parallel.
+// Coverage uses 8-bit subpixel fixed point with a top-left fill rule; depth is GL_LESS.
+class SoftwareRasterizer
+{
+public:
+    static const int TILE_SIZE = 64;
+
+    explicit SoftwareRasterizer(JobSystem& jobs);
+
+    void resize(int width, int height);
+    void clear(const glm::vec3& color, float depth = 1.0f);
+
+    // Queue one indexed draw with a flat color. positions (xyz) and indices must stay
+    // valid until flush(); indices are relative to baseVertex like glDrawElementsBaseVertex.
+    void draw(const float* positions, int baseVertex, unsigned int vertexCount,
+              const unsigned int* indices, unsigned int indexCount,
+              const glm::mat4& mvp, const glm::vec3& color);
+
+    // Run everything queued since the last flush, in submission order
+    void flush();
+
+    int width() const { return targetWidth; }
+    int height() const { return targetHeight; }
+
+    // RGBA8 pixels with row 0 at the bottom, the same layout glReadPixels returns
+    const std::vector<uint32_t>& colorBuffer() const { return color; }
+
+    const RasterStats& stats() const { return counters; }
+    void resetStats() { counters = RasterStats(); }
+
+private:
+    struct DrawCall
+    {
+        const float* positions;
+        int baseVertex;
+        unsigned int vertexCount;
+        const unsigned int* indices;
+        unsigned int indexCount;
+        glm::mat4 mvp;
+        uint32_t color;
+    };
+
+    // A triangle ready for rasterization, in window coordinates
+    struct SetupTriangle
+    {
+        int64_t x[3], y[3];     // 24.8 fixed point
+        float z0, dzdx, dzdy;   // window depth plane, relative to vertex 0
+        int minX, minY, maxX, maxY;
+        uint32_t color;
+    };
+
+    void flushBatch(size_t firstDraw, size_t lastDraw);
+    void setupChunk(int chunk, size_t firstTriangle, size_t lastTriangle, size_t firstDraw, size_t batchDraw);
+    void setupTriangle(int chunk, const glm::vec4* clip, uint32_t triangleColor);
+    void emitTriangle(int chunk, const glm::vec4& a, const glm::vec4& b, const glm::vec4& c, uint32_t triangleColor);
+    void rasterizeTile(int tile);
+
+    JobSystem& jobs;
+    int targetWidth = 0;
+    int targetHeight = 0;
+    int tilesX = 0;
+    int tilesY = 0;
+    std::vector<uint32_t> color;
+    std::vector<float> depth;
+
+    std::vector<DrawCall> draws;
+
+    // Per batch scratch: clip-space vertices of every draw and where each draw starts
+    std::vector<float> clipX, clipY, clipZ, clipW;
+    std::vector<size_t> drawVertexStart;
+    std::vector<size_t> drawTriangleStart;
+
+    // Setup output, one list per setup chunk so chunks never share a lock.
+    // bins[chunk * tileCount + tile] holds indices into triangles[chunk].
+    std::vector<std::vector<SetupTriangle>> triangles;
+    std::vector<std::vector<uint32_t>> bins;
+    std::vector<RasterStats> chunkStats;
+    std::vector<RasterStats> tileStats;
+    int chunkCount = 0;
+
+    RasterStats counters;
+};
+
+// Per-pixel comparison of two RGBA8 images of the same size
+struct ImageDiff
+{
+    size_t pixels = 0;
+    size_t mismatched = 0;      // pixels where any channel differs by more than the tolerance
+    int maxChannelDiff = 0;
+    double mismatchFraction() const { return pixels ? (double)mismatched / (double)pixels : 0.0; }
+};
+
+ImageDiff compareImages(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b, int tolerance);
+
+// Draw one frame of the cube grid exactly as the GL render loop does.
+// instanced selects the instanced shader's model-space rule (placement kept).
+void renderSceneSoftware(SoftwareRasterizer& raster, const SceneLayout& scene, const MeshRegistry& meshes,
+                         const std::vector<int>& objectMeshes, int activeSpace, bool instanced, float time);
+
+#endif
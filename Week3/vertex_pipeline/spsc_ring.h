@@ -0,0 +1,63 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+
+// Lock-free ring of CAPACITY slots between exactly one producer and one consumer thread.
+// Slots are filled and read in place, so whatever they own (vectors, queues) is allocated
+// once and reused. The producer claims a slot with tryBeginWrite(), fills it and publishes
+// it with endWrite(); the consumer mirrors that with tryBeginRead() and endRead().
+template <typename T, size_t CAPACITY>
+class SpscRing
+{
+public:
+    // Producer: the next slot to fill, or nullptr while every slot is unread
+    T* tryBeginWrite()
+    {
+        const size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - readIndex.load(std::memory_order_acquire) == CAPACITY)
+            return nullptr;
+        return &slots[head % CAPACITY];
+    }
+
+    void endWrite()
+    {
+        writeIndex.store(writeIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: the oldest published slot, or nullptr while there is none
+    T* tryBeginRead()
+    {
+        const size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (writeIndex.load(std::memory_order_acquire) == tail)
+            return nullptr;
+        return &slots[tail % CAPACITY];
+    }
+
+    void endRead()
+    {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    T slots[CAPACITY];
+    // Each index on its own cache line so the two threads do not share one
+    alignas(64) std::atomic<size_t> writeIndex{ 0 };
+    alignas(64) std::atomic<size_t> readIndex{ 0 };
+};
+
+// Back off while the other side of a ring catches up: spin briefly, then yield, then sleep
+inline void ringBackoff(int attempt)
+{
+    if (attempt < 64)
+        return;
+    if (attempt < 256)
+        std::this_thread::yield();
+    else
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+}
+
+#endif
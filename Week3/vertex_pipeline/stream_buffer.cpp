@@ -0,0 +1,114 @@
+#include "stream_buffer.h"
+
+#include "gl_state.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+bool StreamBuffer::init(size_t bytesPerFrame)
+{
+    // Keep every region start aligned for any use of the buffer
+    regionBytes = (bytesPerFrame + 255) / 256 * 256;
+    const size_t totalBytes = regionBytes * FRAMES;
+
+    glGenBuffers(1, &buffer);
+    glState().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    const bool useStorage = GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage;
+    if (useStorage)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, (GLsizeiptr)totalBytes, NULL, flags);
+        mapped = (unsigned char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, (GLsizeiptr)totalBytes, flags);
+        if (!mapped)
+            std::cout << "ERROR::STREAM_BUFFER::MAP_FAILED" << std::endl;
+    }
+    else
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)totalBytes, NULL, GL_STREAM_DRAW);
+    }
+
+    region = FRAMES - 1;
+    cursor = 0;
+    return !useStorage || mapped != nullptr;
+}
+
+void StreamBuffer::destroy()
+{
+    for (int i = 0; i < FRAMES; ++i)
+    {
+        if (fences[i])
+            glDeleteSync(fences[i]);
+        fences[i] = 0;
+    }
+    if (mapped)
+    {
+        glState().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        mapped = nullptr;
+    }
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
+
+void StreamBuffer::beginFrame()
+{
+    region = (region + 1) % FRAMES;
+    cursor = 0;
+    ++counters.frames;
+
+    GLsync fence = fences[region];
+    if (!fence)
+        return;
+    fences[region] = 0;
+
+    // Poll first so the common case costs no flush; only then block, flushing once
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        ++counters.fenceWaits;
+        auto waitStart = std::chrono::steady_clock::now();
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        do
+        {
+            status = glClientWaitSync(fence, flags, 1000000);
+            flags = 0;
+        } while (status == GL_TIMEOUT_EXPIRED);
+        counters.waitMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+    }
+    if (status == GL_WAIT_FAILED)
+        std::cout << "ERROR::STREAM_BUFFER::WAIT_FAILED" << std::endl;
+    glDeleteSync(fence);
+}
+
+void StreamBuffer::endFrame()
+{
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    counters.peakBytes = std::max(counters.peakBytes, cursor);
+}
+
+bool StreamBuffer::upload(const void* data, size_t bytes, size_t alignment, size_t& offset)
+{
+    size_t start = (cursor + alignment - 1) / alignment * alignment;
+    if (start + bytes > regionBytes)
+    {
+        ++counters.overflows;
+        return false;
+    }
+    cursor = start + bytes;
+    offset = regionBytes * (size_t)region + start;
+
+    if (mapped)
+    {
+        std::memcpy(mapped + offset, data, bytes);
+    }
+    else
+    {
+        // The copy-write target is only ever used for this buffer, so this bind is
+        // issued once and elided from then on
+        glState().bindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)bytes, data);
+    }
+    return true;
+}
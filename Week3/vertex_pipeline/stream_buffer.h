@@ -0,0 +1,57 @@
+#ifndef STREAM_BUFFER_H
+#define STREAM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// How often the CPU had to wait for the GPU, and whether the per-frame budget was enough
+struct StreamStats
+{
+    uint64_t frames = 0;
+    uint64_t fenceWaits = 0;        // frames whose region was still in use by the GPU
+    double waitMs = 0.0;            // total time spent in those waits
+    uint64_t overflows = 0;         // uploads refused because the frame's region was full
+    size_t peakBytes = 0;           // most bytes used by one frame
+};
+
+// One large buffer for all per-frame dynamic data (uniforms, instance data, draw commands,
+// overlay quads), split into a region per frame in flight. Each frame sub-allocates linearly
+// from its own region and fences it at the end, and a region is only reused once its fence
+// has signaled, so uploads never orphan and never write over data the GPU is still reading.
+// With GL 4.4 or ARB_buffer_storage the buffer is persistently and coherently mapped and an
+// upload is a memcpy; otherwise uploads go through glBufferSubData into the fenced region.
+class StreamBuffer
+{
+public:
+    static const int FRAMES = 3;
+
+    bool init(size_t bytesPerFrame);
+    void destroy();
+
+    // Move to the next region, waiting for the GPU to release it if necessary
+    void beginFrame();
+    // Fence the current region; call after the last command that reads this frame's data
+    void endFrame();
+
+    // Copy data into the current region at the given alignment and return its offset in
+    // the buffer. Returns false and counts an overflow when the region is full.
+    bool upload(const void* data, size_t bytes, size_t alignment, size_t& offset);
+
+    unsigned int handle() const { return buffer; }
+    bool persistent() const { return mapped != nullptr; }
+    size_t regionSize() const { return regionBytes; }
+    const StreamStats& stats() const { return counters; }
+
+private:
+    unsigned int buffer = 0;
+    unsigned char* mapped = nullptr;
+    size_t regionBytes = 0;
+    size_t cursor = 0;              // bytes used in the current region
+    int region = 0;
+    GLsync fences[FRAMES] = {};
+    StreamStats counters;
+};
+
+#endif
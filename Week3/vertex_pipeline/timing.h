@@ -0,0 +1,29 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <chrono>
+#include <cstddef>
+
+inline double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Average milliseconds per call of fn over at least minSeconds, for the --bench runs
+template <typename Fn>
+double millisecondsPerCall(double minSeconds, Fn fn)
+{
+    fn();   // warm caches and size the outputs
+    size_t calls = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    do
+    {
+        fn();
+        ++calls;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < minSeconds);
+    return elapsed * 1000.0 / (double)calls;
+}
+
+#endif
@@ -0,0 +1,188 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> traceRunning{ false };
+
+namespace
+{
+    // Events per thread; a frame records a dozen or so on the main thread,
+    // so this holds tens of thousands of frames
+    const size_t RING_EVENTS = (size_t)1 << 18;
+
+    struct TraceEvent
+    {
+        const char* name;
+        uint64_t startNs;
+        uint64_t endNs;
+    };
+
+    struct ThreadRing
+    {
+        int id = 0;
+        std::string name;
+        std::vector<TraceEvent> events;
+        std::atomic<uint64_t> written{ 0 };
+    };
+
+    // Rings are owned here rather than by their threads so a trace can still be written
+    // after a worker pool has shut down. A thread only gets one once it records an event.
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+    int nextRingId = 1;
+    // Full-size event buffers of threads that have exited, for the next thread that records
+    std::vector<std::vector<TraceEvent>> freeBuffers;
+
+    // Retires the thread's ring when the thread exits: its events are moved into a buffer
+    // just big enough to hold them, and the full-size one goes back to freeBuffers, so pools
+    // created over and over do not each keep megabytes of ring around
+    struct ThreadSlot
+    {
+        ThreadRing* ring = nullptr;
+        std::string name;
+
+        ~ThreadSlot()
+        {
+            if (!ring)
+                return;
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            const uint64_t written = ring->written.load(std::memory_order_relaxed);
+            const uint64_t first = written > RING_EVENTS ? written - RING_EVENTS : 0;
+            std::vector<TraceEvent> kept;
+            kept.reserve((size_t)(written - first));
+            for (uint64_t i = first; i < written; ++i)
+                kept.push_back(ring->events[i & (RING_EVENTS - 1)]);
+            freeBuffers.push_back(std::move(ring->events));
+            // Oldest first from index 0, which is where the exporter looks for kept.size() events
+            ring->events = std::move(kept);
+            ring->written.store(ring->events.size(), std::memory_order_relaxed);
+        }
+    };
+    thread_local ThreadSlot threadSlot;
+
+    ThreadRing* ringForThisThread()
+    {
+        if (threadSlot.ring)
+            return threadSlot.ring;
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        rings.emplace_back(new ThreadRing());
+        ThreadRing* ring = rings.back().get();
+        ring->id = nextRingId++;
+        ring->name = threadSlot.name.empty() ? "thread " + std::to_string(ring->id) : threadSlot.name;
+        if (freeBuffers.empty())
+        {
+            ring->events.resize(RING_EVENTS);
+        }
+        else
+        {
+            ring->events = std::move(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+        threadSlot.ring = ring;
+        return ring;
+    }
+
+    // Names are source literals; escape anyway so a stray quote cannot break the file
+    void writeString(std::ostream& out, const char* text)
+    {
+        out << '"';
+        for (const char* c = text; *c; ++c)
+        {
+            if (*c == '"' || *c == '\\')
+                out << '\\';
+            if ((unsigned char)*c >= 0x20)
+                out << *c;
+        }
+        out << '"';
+    }
+}
+
+uint64_t traceNowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void traceStart()
+{
+    traceRunning.store(true, std::memory_order_relaxed);
+}
+
+void traceStop()
+{
+    traceRunning.store(false, std::memory_order_relaxed);
+}
+
+void traceRecord(const char* name, uint64_t startNs, uint64_t endNs)
+{
+    ThreadRing* ring = ringForThisThread();
+    uint64_t index = ring->written.load(std::memory_order_relaxed);
+    ring->events[index & (RING_EVENTS - 1)] = TraceEvent{ name, startNs, endNs };
+    ring->written.store(index + 1, std::memory_order_release);
+}
+
+void traceSetThreadName(const std::string& name)
+{
+    // Only the name is kept until the thread records something
+    threadSlot.name = name;
+    if (threadSlot.ring)
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        threadSlot.ring->name = name;
+    }
+}
+
+bool traceWriteJson(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        std::cout << "ERROR::TRACE::CANNOT_WRITE " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(ringsMutex);
+
+    // Timestamps are relative to the earliest surviving event, in microseconds
+    uint64_t origin = UINT64_MAX;
+    for (const auto& ring : rings)
+    {
+        uint64_t written = ring->written.load(std::memory_order_acquire);
+        uint64_t first = written > RING_EVENTS ? written - RING_EVENTS : 0;
+        for (uint64_t i = first; i < written; ++i)
+            origin = std::min(origin, ring->events[i & (RING_EVENTS - 1)].startNs);
+    }
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool firstEvent = true;
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    for (const auto& ring : rings)
+    {
+        out << (firstEvent ? "" : ",\n")
+            << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->id << ",\"args\":{\"name\":";
+        writeString(out, ring->name.c_str());
+        out << "}}";
+        firstEvent = false;
+
+        uint64_t written = ring->written.load(std::memory_order_acquire);
+        uint64_t first = written > RING_EVENTS ? written - RING_EVENTS : 0;
+        for (uint64_t i = first; i < written; ++i)
+        {
+            const TraceEvent& event = ring->events[i & (RING_EVENTS - 1)];
+            out << ",\n{\"name\":";
+            writeString(out, event.name);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->id
+                << ",\"ts\":" << (double)(event.startNs - origin) / 1000.0
+                << ",\"dur\":" << (double)(event.endNs - event.startNs) / 1000.0 << "}";
+        }
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
@@ -0,0 +1,65 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Scoped CPU instrumentation exported as Chrome trace JSON, which Perfetto and
+// chrome://tracing load directly. Every thread records complete events into its own
+// ring buffer without taking locks; once a ring is full its oldest events are overwritten.
+//
+// Builds without VP_TRACING compile the macros away. With it compiled in but not started,
+// a scope costs one relaxed atomic load.
+
+extern std::atomic<bool> traceRunning;
+
+// Nanoseconds on the steady clock
+uint64_t traceNowNs();
+
+// Start or stop recording on every thread
+void traceStart();
+void traceStop();
+
+// Record one finished event on the calling thread. name must outlive the trace (a literal).
+void traceRecord(const char* name, uint64_t startNs, uint64_t endNs);
+
+// Label the calling thread in the exported trace
+void traceSetThreadName(const std::string& name);
+
+// Write everything recorded so far. Call while no thread is recording.
+bool traceWriteJson(const std::string& path);
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* eventName)
+        : name(traceRunning.load(std::memory_order_relaxed) ? eventName : nullptr), start(name ? traceNowNs() : 0)
+    {
+    }
+
+    ~TraceScope()
+    {
+        if (name)
+            traceRecord(name, start, traceNowNs());
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
+
+#if defined(VP_TRACING)
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#define TRACE_THREAD_NAME(name) traceSetThreadName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif
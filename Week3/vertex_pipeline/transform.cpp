@@ -0,0 +1,236 @@
+#include "transform.h"
+#include "transform_kernels.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+void transformStreamScalar(const float* m, const float* x, const float* y, const float* z, const float* w,
+                           float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        float vx = x[i], vy = y[i], vz = z[i];
+        float vw = w ? w[i] : 1.0f;
+        ox[i] = m[0] * vx + m[4] * vy + m[8] * vz + m[12] * vw;
+        oy[i] = m[1] * vx + m[5] * vy + m[9] * vz + m[13] * vw;
+        oz[i] = m[2] * vx + m[6] * vy + m[10] * vz + m[14] * vw;
+        ow[i] = m[3] * vx + m[7] * vy + m[11] * vz + m[15] * vw;
+    }
+}
+
+// Builds without a given ISA get a stub that is never reached, since kernelSupported() says no
+#ifndef VP_HAVE_SSE4
+void transformStreamSSE4(const float* m, const float* x, const float* y, const float* z, const float* w,
+                         float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    transformStreamScalar(m, x, y, z, w, ox, oy, oz, ow, count);
+}
+#endif
+#ifndef VP_HAVE_AVX2
+void transformStreamAVX2(const float* m, const float* x, const float* y, const float* z, const float* w,
+                         float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    transformStreamScalar(m, x, y, z, w, ox, oy, oz, ow, count);
+}
+#endif
+#ifndef VP_HAVE_AVX512
+void transformStreamAVX512(const float* m, const float* x, const float* y, const float* z, const float* w,
+                           float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    transformStreamScalar(m, x, y, z, w, ox, oy, oz, ow, count);
+}
+#endif
+
+const char* kernelName(TransformKernel kernel)
+{
+    switch (kernel) {
+        case TransformKernel::Scalar:
+            return "scalar";
+        case TransformKernel::SSE4:
+            return "sse4";
+        case TransformKernel::AVX2:
+            return "avx2";
+        case TransformKernel::AVX512:
+            return "avx512";
+    }
+    return "unknown";
+}
+
+bool kernelSupported(TransformKernel kernel)
+{
+    switch (kernel) {
+        case TransformKernel::Scalar:
+            return true;
+#if defined(VP_HAVE_SSE4)
+        case TransformKernel::SSE4:
+            return __builtin_cpu_supports("sse4.1");
+#endif
+#if defined(VP_HAVE_AVX2)
+        case TransformKernel::AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#if defined(VP_HAVE_AVX512)
+        case TransformKernel::AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+TransformKernel bestKernel()
+{
+    const TransformKernel order[] = { TransformKernel::AVX512, TransformKernel::AVX2, TransformKernel::SSE4 };
+    for (TransformKernel kernel : order)
+    {
+        if (kernelSupported(kernel))
+            return kernel;
+    }
+    return TransformKernel::Scalar;
+}
+
+void SoAVertices::resize(size_t count)
+{
+    x.resize(count);
+    y.resize(count);
+    z.resize(count);
+    w.resize(count);
+}
+
+VertexStreamIn SoAVertices::in() const
+{
+    VertexStreamIn stream;
+    stream.x = x.data();
+    stream.y = y.data();
+    stream.z = z.data();
+    stream.w = w.data();
+    return stream;
+}
+
+VertexStreamOut SoAVertices::out()
+{
+    VertexStreamOut stream;
+    stream.x = x.data();
+    stream.y = y.data();
+    stream.z = z.data();
+    stream.w = w.data();
+    return stream;
+}
+
+void transformStream(TransformKernel kernel, const glm::mat4& matrix,
+                     VertexStreamIn in, VertexStreamOut out, size_t count)
+{
+    const float* m = glm::value_ptr(matrix);
+    switch (kernel) {
+        case TransformKernel::SSE4:
+            transformStreamSSE4(m, in.x, in.y, in.z, in.w, out.x, out.y, out.z, out.w, count);
+            break;
+        case TransformKernel::AVX2:
+            transformStreamAVX2(m, in.x, in.y, in.z, in.w, out.x, out.y, out.z, out.w, count);
+            break;
+        case TransformKernel::AVX512:
+            transformStreamAVX512(m, in.x, in.y, in.z, in.w, out.x, out.y, out.z, out.w, count);
+            break;
+        default:
+            transformStreamScalar(m, in.x, in.y, in.z, in.w, out.x, out.y, out.z, out.w, count);
+            break;
+    }
+}
+
+static VertexStreamIn asInput(const VertexStreamOut& out)
+{
+    VertexStreamIn in;
+    in.x = out.x;
+    in.y = out.y;
+    in.z = out.z;
+    in.w = out.w;
+    return in;
+}
+
+void transformPositions(TransformKernel kernel, const TransformMatrices& matrices,
+                        VertexStreamIn positions, const SpaceOutputs& outputs, size_t count)
+{
+    const bool wantWorld = outputs.world.x != nullptr;
+    const bool wantView = outputs.view.x != nullptr;
+
+    // Only clip space requested: one fused matrix, one pass
+    if (!wantWorld && !wantView)
+    {
+        glm::mat4 mvp = matrices.projection * matrices.view * matrices.model;
+        transformStream(kernel, mvp, positions, outputs.clip, count);
+        return;
+    }
+
+    // Otherwise walk the chain, starting each stage from the last space that was stored
+    VertexStreamIn current = positions;
+    glm::mat4 pending = matrices.model;
+    if (wantWorld)
+    {
+        transformStream(kernel, pending, current, outputs.world, count);
+        current = asInput(outputs.world);
+        pending = glm::mat4(1.0f);
+    }
+    pending = matrices.view * pending;
+    if (wantView)
+    {
+        transformStream(kernel, pending, current, outputs.view, count);
+        current = asInput(outputs.view);
+        pending = glm::mat4(1.0f);
+    }
+    transformStream(kernel, matrices.projection * pending, current, outputs.clip, count);
+}
+
+float validateKernel(TransformKernel kernel, size_t count)
+{
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coord(-10.0f, 10.0f);
+
+    SoAVertices input;
+    input.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        input.x[i] = coord(rng);
+        input.y[i] = coord(rng);
+        input.z[i] = coord(rng);
+        input.w[i] = 1.0f;
+    }
+
+    TransformMatrices matrices;
+    matrices.model = glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.3f, -1.2f, 0.5f)), 0.7f, glm::vec3(0.5f, 1.0f, 0.0f));
+    matrices.view = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -3.0f));
+    matrices.projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+
+    SoAVertices world, view, clip;
+    world.resize(count);
+    view.resize(count);
+    clip.resize(count);
+    SpaceOutputs outputs;
+    outputs.world = world.out();
+    outputs.view = view.out();
+    outputs.clip = clip.out();
+    transformPositions(kernel, matrices, input.in(), outputs, count);
+
+    // Relative error against glm, per emitted space
+    float worst = 0.0f;
+    auto compare = [&worst](const glm::vec4& expected, const SoAVertices& actual, size_t i) {
+        float scale = std::max(1.0f, glm::length(expected));
+        float error = std::max(std::max(std::fabs(expected.x - actual.x[i]), std::fabs(expected.y - actual.y[i])),
+                               std::max(std::fabs(expected.z - actual.z[i]), std::fabs(expected.w - actual.w[i])));
+        worst = std::max(worst, error / scale);
+    };
+    for (size_t i = 0; i < count; ++i)
+    {
+        glm::vec4 p(input.x[i], input.y[i], input.z[i], 1.0f);
+        glm::vec4 w = matrices.model * p;
+        glm::vec4 v = matrices.view * w;
+        glm::vec4 c = matrices.projection * v;
+        compare(w, world, i);
+        compare(v, view, i);
+        compare(c, clip, i);
+    }
+    return worst;
+}
@@ -0,0 +1,82 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// CPU reference of the model -> world -> view -> clip chain the vertex shader runs,
+// over structure-of-arrays position streams.
+
+// Kernels, from slowest to fastest. Only those the CPU supports can be used.
+enum class TransformKernel
+{
+    Scalar,
+    SSE4,
+    AVX2,
+    AVX512
+};
+
+const char* kernelName(TransformKernel kernel);
+bool kernelSupported(TransformKernel kernel);
+TransformKernel bestKernel();
+
+// Read-only SoA stream. A null w means every w is 1 (plain positions).
+struct VertexStreamIn
+{
+    const float* x = nullptr;
+    const float* y = nullptr;
+    const float* z = nullptr;
+    const float* w = nullptr;
+};
+
+// Writable SoA stream. A null x means "do not produce this stream".
+struct VertexStreamOut
+{
+    float* x = nullptr;
+    float* y = nullptr;
+    float* z = nullptr;
+    float* w = nullptr;
+};
+
+// Owning SoA storage for one coordinate space
+struct SoAVertices
+{
+    std::vector<float> x, y, z, w;
+
+    void resize(size_t count);
+    size_t size() const { return x.size(); }
+    VertexStreamIn in() const;
+    VertexStreamOut out();
+};
+
+struct TransformMatrices
+{
+    glm::mat4 model;
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+
+// Which intermediate spaces to emit. Clip is always required.
+struct SpaceOutputs
+{
+    VertexStreamOut world;
+    VertexStreamOut view;
+    VertexStreamOut clip;
+};
+
+// out = matrix * in, four components per vertex
+void transformStream(TransformKernel kernel, const glm::mat4& matrix,
+                     VertexStreamIn in, VertexStreamOut out, size_t count);
+
+// Run model-space positions through the full chain. When no intermediate space is
+// requested the three matrices are folded into one and each vertex is transformed once.
+void transformPositions(TransformKernel kernel, const TransformMatrices& matrices,
+                        VertexStreamIn positions, const SpaceOutputs& outputs, size_t count);
+
+// Compare a kernel against glm::mat4 * glm::vec4 on random data.
+// Returns the largest relative error seen.
+float validateKernel(TransformKernel kernel, size_t count);
+
+#endif
@@ -0,0 +1,62 @@
+#include "transform_kernels.h"
+
+#include <immintrin.h>
+
+// Eight vertices per iteration, three FMAs and one multiply (or add) per output row.
+template <bool HasW>
+static void transformAVX2(const float* m, const float* x, const float* y, const float* z, const float* w,
+                          float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    __m256 c[16];
+    for (int i = 0; i < 16; ++i)
+        c[i] = _mm256_set1_ps(m[i]);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 vx = _mm256_loadu_ps(x + i);
+        __m256 vy = _mm256_loadu_ps(y + i);
+        __m256 vz = _mm256_loadu_ps(z + i);
+
+        // With w == 1 the translation column is the starting value instead of a multiply
+        __m256 rx, ry, rz, rw;
+        if (HasW)
+        {
+            __m256 vw = _mm256_loadu_ps(w + i);
+            rx = _mm256_mul_ps(c[12], vw);
+            ry = _mm256_mul_ps(c[13], vw);
+            rz = _mm256_mul_ps(c[14], vw);
+            rw = _mm256_mul_ps(c[15], vw);
+        }
+        else
+        {
+            rx = c[12];
+            ry = c[13];
+            rz = c[14];
+            rw = c[15];
+        }
+
+        rx = _mm256_fmadd_ps(c[0], vx, _mm256_fmadd_ps(c[4], vy, _mm256_fmadd_ps(c[8], vz, rx)));
+        ry = _mm256_fmadd_ps(c[1], vx, _mm256_fmadd_ps(c[5], vy, _mm256_fmadd_ps(c[9], vz, ry)));
+        rz = _mm256_fmadd_ps(c[2], vx, _mm256_fmadd_ps(c[6], vy, _mm256_fmadd_ps(c[10], vz, rz)));
+        rw = _mm256_fmadd_ps(c[3], vx, _mm256_fmadd_ps(c[7], vy, _mm256_fmadd_ps(c[11], vz, rw)));
+
+        _mm256_storeu_ps(ox + i, rx);
+        _mm256_storeu_ps(oy + i, ry);
+        _mm256_storeu_ps(oz + i, rz);
+        _mm256_storeu_ps(ow + i, rw);
+    }
+
+    if (i < count)
+        transformStreamScalar(m, x + i, y + i, z + i, HasW ? w + i : nullptr,
+                              ox + i, oy + i, oz + i, ow + i, count - i);
+}
+
+void transformStreamAVX2(const float* m, const float* x, const float* y, const float* z, const float* w,
+                         float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    if (w)
+        transformAVX2<true>(m, x, y, z, w, ox, oy, oz, ow, count);
+    else
+        transformAVX2<false>(m, x, y, z, w, ox, oy, oz, ow, count);
+}
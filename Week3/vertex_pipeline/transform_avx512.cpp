@@ -0,0 +1,62 @@
+#include "transform_kernels.h"
+
+#include <immintrin.h>
+
+// Sixteen vertices per iteration; same structure as the AVX2 kernel on 512-bit registers.
+template <bool HasW>
+static void transformAVX512(const float* m, const float* x, const float* y, const float* z, const float* w,
+                          float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    __m512 c[16];
+    for (int i = 0; i < 16; ++i)
+        c[i] = _mm512_set1_ps(m[i]);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m512 vx = _mm512_loadu_ps(x + i);
+        __m512 vy = _mm512_loadu_ps(y + i);
+        __m512 vz = _mm512_loadu_ps(z + i);
+
+        // With w == 1 the translation column is the starting value instead of a multiply
+        __m512 rx, ry, rz, rw;
+        if (HasW)
+        {
+            __m512 vw = _mm512_loadu_ps(w + i);
+            rx = _mm512_mul_ps(c[12], vw);
+            ry = _mm512_mul_ps(c[13], vw);
+            rz = _mm512_mul_ps(c[14], vw);
+            rw = _mm512_mul_ps(c[15], vw);
+        }
+        else
+        {
+            rx = c[12];
+            ry = c[13];
+            rz = c[14];
+            rw = c[15];
+        }
+
+        rx = _mm512_fmadd_ps(c[0], vx, _mm512_fmadd_ps(c[4], vy, _mm512_fmadd_ps(c[8], vz, rx)));
+        ry = _mm512_fmadd_ps(c[1], vx, _mm512_fmadd_ps(c[5], vy, _mm512_fmadd_ps(c[9], vz, ry)));
+        rz = _mm512_fmadd_ps(c[2], vx, _mm512_fmadd_ps(c[6], vy, _mm512_fmadd_ps(c[10], vz, rz)));
+        rw = _mm512_fmadd_ps(c[3], vx, _mm512_fmadd_ps(c[7], vy, _mm512_fmadd_ps(c[11], vz, rw)));
+
+        _mm512_storeu_ps(ox + i, rx);
+        _mm512_storeu_ps(oy + i, ry);
+        _mm512_storeu_ps(oz + i, rz);
+        _mm512_storeu_ps(ow + i, rw);
+    }
+
+    if (i < count)
+        transformStreamScalar(m, x + i, y + i, z + i, HasW ? w + i : nullptr,
+                              ox + i, oy + i, oz + i, ow + i, count - i);
+}
+
+void transformStreamAVX512(const float* m, const float* x, const float* y, const float* z, const float* w,
+                         float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    if (w)
+        transformAVX512<true>(m, x, y, z, w, ox, oy, oz, ow, count);
+    else
+        transformAVX512<false>(m, x, y, z, w, ox, oy, oz, ow, count);
+}
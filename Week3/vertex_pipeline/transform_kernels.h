@@ -0,0 +1,18 @@
+#ifndef TRANSFORM_KERNELS_H
+#define TRANSFORM_KERNELS_H
+
+#include <cstddef>
+
+// Per-ISA kernels behind transformStream(). Each lives in its own translation unit
+// compiled with the matching instruction set flags, and is only called after a CPUID check.
+// m is a column-major 4x4 matrix; w may be null (all ones).
+void transformStreamScalar(const float* m, const float* x, const float* y, const float* z, const float* w,
+                           float* ox, float* oy, float* oz, float* ow, size_t count);
+void transformStreamSSE4(const float* m, const float* x, const float* y, const float* z, const float* w,
+                         float* ox, float* oy, float* oz, float* ow, size_t count);
+void transformStreamAVX2(const float* m, const float* x, const float* y, const float* z, const float* w,
+                         float* ox, float* oy, float* oz, float* ow, size_t count);
+void transformStreamAVX512(const float* m, const float* x, const float* y, const float* z, const float* w,
+                           float* ox, float* oy, float* oz, float* ow, size_t count);
+
+#endif
@@ -0,0 +1,50 @@
+#include "transform_kernels.h"
+
+#include <immintrin.h>
+
+// Four vertices per iteration. The matrix columns are broadcast once up front.
+template <bool HasW>
+static void transformSSE4(const float* m, const float* x, const float* y, const float* z, const float* w,
+                          float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    __m128 c[16];
+    for (int i = 0; i < 16; ++i)
+        c[i] = _mm_set1_ps(m[i]);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 vx = _mm_loadu_ps(x + i);
+        __m128 vy = _mm_loadu_ps(y + i);
+        __m128 vz = _mm_loadu_ps(z + i);
+        __m128 vw = HasW ? _mm_loadu_ps(w + i) : one;
+
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[0], vx), _mm_mul_ps(c[4], vy)),
+                               _mm_add_ps(_mm_mul_ps(c[8], vz), _mm_mul_ps(c[12], vw)));
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[1], vx), _mm_mul_ps(c[5], vy)),
+                               _mm_add_ps(_mm_mul_ps(c[9], vz), _mm_mul_ps(c[13], vw)));
+        __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[2], vx), _mm_mul_ps(c[6], vy)),
+                               _mm_add_ps(_mm_mul_ps(c[10], vz), _mm_mul_ps(c[14], vw)));
+        __m128 rw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[3], vx), _mm_mul_ps(c[7], vy)),
+                               _mm_add_ps(_mm_mul_ps(c[11], vz), _mm_mul_ps(c[15], vw)));
+
+        _mm_storeu_ps(ox + i, rx);
+        _mm_storeu_ps(oy + i, ry);
+        _mm_storeu_ps(oz + i, rz);
+        _mm_storeu_ps(ow + i, rw);
+    }
+
+    if (i < count)
+        transformStreamScalar(m, x + i, y + i, z + i, HasW ? w + i : nullptr,
+                              ox + i, oy + i, oz + i, ow + i, count - i);
+}
+
+void transformStreamSSE4(const float* m, const float* x, const float* y, const float* z, const float* w,
+                         float* ox, float* oy, float* oz, float* ow, size_t count)
+{
+    if (w)
+        transformSSE4<true>(m, x, y, z, w, ox, oy, oz, ow, count);
+    else
+        transformSSE4<false>(m, x, y, z, w, ox, oy, oz, ow, count);
+}
@@ -0,0 +1,17 @@
+#include "uniform_buffer.h"
+
+#include "gl_state.h"
+
+bool uploadUniformBlock(StreamBuffer& stream, int binding, const void* data, size_t size)
+{
+    // Block offsets have to respect the driver's alignment
+    static int alignment = 0;
+    if (alignment == 0)
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    size_t offset = 0;
+    if (!stream.upload(data, size, (size_t)alignment, offset))
+        return false;
+    glState().bindUniformRange(binding, stream.handle(), offset, size);
+    return true;
+}
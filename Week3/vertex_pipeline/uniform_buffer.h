@@ -0,0 +1,26 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include "stream_buffer.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+
+// Binding points shared by every program that declares these blocks
+const int FRAME_DATA_BINDING = 0;
+
+// Per-frame data, laid out to match the std140 FrameData block in the shaders
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    float time;
+    float padding[3];
+};
+static_assert(sizeof(FrameData) == 144, "FrameData must match the std140 layout");
+
+// Copy a uniform block into this frame's region of the stream buffer and bind it there
+bool uploadUniformBlock(StreamBuffer& stream, int binding, const void* data, size_t size);
+
+#endif